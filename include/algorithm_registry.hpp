@@ -0,0 +1,20 @@
+#ifndef ALGORITHM_REGISTRY_HPP
+#define ALGORITHM_REGISTRY_HPP
+
+#include "executor.hpp"
+#include <string>
+#include <vector>
+
+// Named entry points of SearchAlgorithms, for drivers that pick algorithms at
+// run time (benchmarks, batch mode). Thread counts come from the
+// SearchAlgorithms fields (bfs_threads, astar_threads, ida_threads).
+struct SearchAlgorithmEntry {
+    const char* name;
+    void (*run)(SearchAlgorithms& search, const std::vector<Jar>& jars);
+};
+
+const std::vector<SearchAlgorithmEntry>& search_algorithms();
+// nullptr if there is no algorithm with that name
+const SearchAlgorithmEntry* find_search_algorithm(const std::string& name);
+
+#endif // ALGORITHM_REGISTRY_HPP
@@ -0,0 +1,36 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "structure.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Batch mode of water_jug. Input is one instance per line:
+//
+//     [algorithm] capacity[:initial] capacity[:initial] ...
+//
+// e.g. "astar 3 5 2" or "bfs 3:1 5 2:2". The algorithm is a name from the
+// algorithm registry and defaults to BatchOptions::algorithm. Blank lines
+// and lines starting with '#' are skipped. Every instance produces one JSON
+// line on the output as soon as it is solved, so results can come out of
+// input order; "line" identifies the instance.
+struct BatchOptions {
+    int threads = 0;                 // 0: one per hardware thread
+    std::string algorithm = "astar";
+};
+
+struct BatchInstance {
+    int line;
+    std::string algorithm;
+    std::vector<Jar> jars;
+};
+
+// Parses one input line. Returns false with `error` set on malformed input.
+bool parse_batch_line(const std::string& text, const std::string& default_algorithm, BatchInstance& out, std::string& error);
+
+// Solves every instance read from `in`, writing JSONL to `out`. Returns the
+// number of lines that failed to parse.
+int run_batch(const BatchOptions& options, std::istream& in, std::ostream& out);
+
+#endif // BATCH_HPP
@@ -0,0 +1,124 @@
+#ifndef BUCKET_QUEUE_HPP
+#define BUCKET_QUEUE_HPP
+
+#include "search_memory.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Monotone bucket queue for small non-negative integer priorities (A* f-costs).
+// Items are node indices. Each bucket is an intrusive doubly linked list, so
+// push, pop and changing an item's priority are all O(1); the pop cursor only
+// moves forward unless an item is pushed below it.
+class BucketQueue {
+public:
+    enum TieBreak {
+        FIFO, // oldest item of the bucket first
+        LIFO  // newest item first (most recently generated, usually lowest h)
+    };
+
+    explicit BucketQueue(TieBreak tie_break = LIFO, SearchMemory* memory = nullptr)
+        : head(ArenaAllocator<int>(memory)), tail(ArenaAllocator<int>(memory)), next(ArenaAllocator<int>(memory)),
+          prev(ArenaAllocator<int>(memory)), prio(ArenaAllocator<int>(memory)), cursor(0), count(0), tie(tie_break) {}
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    bool contains(int item) const {
+        return item < static_cast<int>(prio.size()) && prio[item] >= 0;
+    }
+
+    void clear() {
+        head.clear();
+        tail.clear();
+        next.clear();
+        prev.clear();
+        prio.clear();
+        cursor = 0;
+        count = 0;
+    }
+
+    void push(int item, int priority) {
+        if (item >= static_cast<int>(prio.size())) {
+            size_t n = std::max(static_cast<size_t>(item) + 1, prio.size() * 2);
+            next.resize(n, -1);
+            prev.resize(n, -1);
+            prio.resize(n, -1);
+        }
+        if (priority >= static_cast<int>(head.size())) {
+            head.resize(priority + 1, -1);
+            tail.resize(priority + 1, -1);
+        }
+        link(item, priority);
+        if (priority < cursor) cursor = priority;
+        ++count;
+    }
+
+    // Moves an item to a new priority in place (pushes it if absent)
+    void update(int item, int priority) {
+        if (!contains(item)) {
+            push(item, priority);
+            return;
+        }
+        if (prio[item] == priority) return;
+        unlink(item);
+        --count;
+        push(item, priority);
+    }
+
+    int top_priority() {
+        seek();
+        return cursor;
+    }
+
+    int pop() {
+        seek();
+        int item = head[cursor];
+        unlink(item);
+        --count;
+        return item;
+    }
+
+private:
+    ArenaVector<int> head;
+    ArenaVector<int> tail;
+    ArenaVector<int> next;
+    ArenaVector<int> prev;
+    ArenaVector<int> prio; // -1 when not queued
+    int cursor;
+    size_t count;
+    TieBreak tie;
+
+    void seek() {
+        while (head[cursor] == -1) ++cursor;
+    }
+
+    void link(int item, int priority) {
+        prio[item] = priority;
+        if (head[priority] == -1) {
+            head[priority] = tail[priority] = item;
+            next[item] = prev[item] = -1;
+        } else if (tie == LIFO) {
+            next[item] = head[priority];
+            prev[item] = -1;
+            prev[head[priority]] = item;
+            head[priority] = item;
+        } else {
+            prev[item] = tail[priority];
+            next[item] = -1;
+            next[tail[priority]] = item;
+            tail[priority] = item;
+        }
+    }
+
+    void unlink(int item) {
+        int p = prio[item];
+        if (prev[item] != -1) next[prev[item]] = next[item];
+        else head[p] = next[item];
+        if (next[item] != -1) prev[next[item]] = prev[item];
+        else tail[p] = prev[item];
+        prio[item] = -1;
+    }
+};
+
+#endif // BUCKET_QUEUE_HPP
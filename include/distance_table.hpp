@@ -0,0 +1,61 @@
+#ifndef DISTANCE_TABLE_HPP
+#define DISTANCE_TABLE_HPP
+
+#include "packed_state.hpp"
+#include "structure.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Exact cost-to-goal and best first action of every state of one capacity
+// vector, indexed by the state's perfect rank. It is built by a single
+// backward Dijkstra from the goal, so any initial fill is then solved by
+// following best_action() to the goal.
+//
+// The file written by save() is a small header followed by the raw arrays;
+// load() maps it read-only, so processes solving the same capacities share
+// one copy in the page cache.
+class DistanceTable {
+public:
+    static const uint32_t kUnreachable = 0xFFFFFFFFu;
+    static const uint8_t kNoAction = 0xFF; // goal or unreachable
+
+    ~DistanceTable();
+
+    // Backward search over the whole state space. nullptr if the instance
+    // has more than `max_states` states or no perfect ranking.
+    static std::unique_ptr<DistanceTable> build(const std::vector<Jar>& jars, uint64_t max_states);
+    // Maps a table written by save(); nullptr if the file is missing, damaged
+    // or was built for other capacities
+    static std::unique_ptr<DistanceTable> load(const std::string& path, const std::vector<Jar>& jars);
+    bool save(const std::string& path) const;
+
+    // Cache file name for a capacity vector, e.g. "water_jug_dist_3_5_8.bin"
+    static std::string file_name(const std::vector<Jar>& jars);
+
+    bool matches(const std::vector<Jar>& jars) const;
+    uint64_t size() const { return states; }
+    const StateCodec& codec() const { return state_codec; }
+
+    uint32_t cost_to_goal(const uint16_t* values) const { return dist[state_codec.rank(values)]; }
+    // Index of the action (kernel numbering) that starts an optimal path
+    uint8_t best_action(const uint16_t* values) const { return act[state_codec.rank(values)]; }
+
+private:
+    std::vector<uint16_t> caps;
+    StateCodec state_codec;
+    uint64_t states;
+    const uint32_t* dist;
+    const uint8_t* act;
+    std::vector<uint32_t> own_dist; // set by build()
+    std::vector<uint8_t> own_act;
+    void* mapping;                  // set by load()
+    size_t mapping_size;
+
+    explicit DistanceTable(const std::vector<Jar>& jars);
+    DistanceTable(const DistanceTable&);
+    DistanceTable& operator=(const DistanceTable&);
+};
+
+#endif // DISTANCE_TABLE_HPP
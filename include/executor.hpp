@@ -2,72 +2,169 @@
 #define SEARCH_ALGORITHMS_HPP
 
 #include "structure.hpp"
+#include "node_arena.hpp"
+#include "bucket_queue.hpp"
+#include "jar_heuristic.hpp"
+#include "medidasBuscas.hpp"
+#include "search_memory.hpp"
+#include "search_progress.hpp"
+#include "visited_states.hpp"
 #include <vector>
 #include <iostream>
-#include <unordered_set>
+#include <memory>
+#include <string>
+
+class DistanceTable;
+class SearchTrace;
+
+// One solution of an anytime search: its cost, a proven bound on cost / optimal cost
+// (1 = optimal), the heuristic weight of the pass that found it, and when it was found
+struct AnytimeSolution {
+    int cost;
+    double bound;
+    double weight;
+    double time_ms;
+    uint64_t expansions;
+};
 
 class SearchAlgorithms {
 public:
-    std::vector<GameState> states; // Array of GameState initialized in each search
+    // Arena for the last search's nodes, frontier and hash tables, released when the next one starts.
+    // Parallel engines keep their per-thread structures on the heap.
+    SearchMemory memory;
+    NodeArena nodes; // Nodes generated by the last search (SoA, stable indices)
+    MedidasBusca medidas; // Counters of the last search, filled in while it runs
+    SearchProgress progress; // Live state of the running search, for a ProgressSampler on another thread
+    SearchTrace* trace = nullptr; // When set, searches record spans: IDA* thresholds, BFS layers, A* f-layers
+    bool verbose = true; // false: searches print nothing (batch mode, benchmarks)
+    // BFS, gulosa: state spaces up to this many states use a rank-indexed bitset as visited set
+    uint64_t dense_visited_limit = VisitedStates::kDefaultDenseLimit;
+
+    // A*, ARA*, SMA*, IDA* and gulosa: lower bound on the water still to move (see jar_heuristic.hpp)
+    HeuristicKind heuristic_kind = HEURISTIC_ADJACENT;
+    // HEURISTIC_PDB: jars per window, how windows combine, directory caching one database file per capacity
+    // vector ("" = memory only), largest abstract space per window, and the last database used
+    int pdb_window = 4;
+    PatternDatabase::Combine pdb_combine = PatternDatabase::ADDITIVE;
+    std::string pdb_dir;
+    uint64_t pdb_pattern_limit = 1ULL << 22;
+    std::shared_ptr<const PatternDatabase> pattern_database;
+
+    // A* open list: binary heap with lazy deletion, or bucket queue with decrease-key
+    enum OpenListKind { BINARY_HEAP, BUCKET_QUEUE };
+    OpenListKind astar_open_list = BUCKET_QUEUE;
+    BucketQueue::TieBreak astar_tie_break = BucketQueue::LIFO;
+
+    // busca_gulosa: order among nodes of equal h (oldest, newest or cheapest first), and a beam
+    // width that keeps only the best nodes of the frontier (0 = plain greedy best-first)
+    enum GreedyTieBreak { GREEDY_OLDEST, GREEDY_NEWEST, GREEDY_LOWEST_G };
+    GreedyTieBreak greedy_tie_break = GREEDY_NEWEST;
+    size_t greedy_beam_width = 0;
+
+    // busca_largura: more than one thread expands each BFS layer in parallel
+    int bfs_threads = 1;
+    // busca_largura: a non-zero RAM budget (bytes) runs the disk-backed BFS in bfs_spill_dir
+    size_t bfs_ram_budget = 0;
+    std::string bfs_spill_dir = ".";
+    // solve_with_astar: more than one thread runs hash-distributed A* (HDA*)
+    int astar_threads = 1;
+    // solve_with_ida_star: more than one thread splits each iteration over a work-stealing pool
+    int ida_threads = 1;
+    // solve_with_distance_table: directory caching one table file per capacity vector ("" = memory only),
+    // largest state space it tabulates, and the last table used (reused while capacities match)
+    std::string distance_table_dir;
+    uint64_t distance_table_limit = 1ULL << 26;
+    std::shared_ptr<const DistanceTable> distance_table;
+    // solve_with_ara_star: weight of the first pass, decrease per pass, and budgets after which the best
+    // solution so far is kept (0 = no limit); each improvement is appended to anytime_solutions
+    double ara_initial_weight = 3.0;
+    double ara_weight_step = 0.5;
+    double ara_time_budget_ms = 0;
+    uint64_t ara_node_budget = 0;
+    std::vector<AnytimeSolution> anytime_solutions;
+    // solve_with_sma_star: most nodes held at once, and a byte budget for all of its memory
+    // (0 = none); the tighter of the two sizes its node pool
+    uint64_t sma_node_limit = 1 << 18;
+    uint64_t sma_byte_limit = 0;
+
+    SearchAlgorithms() { nodes.use_memory(&memory); }
 
     void busca_profundidade(const std::vector<Jar> &initial_jars, const int &profundidadeLimite);
     void busca_largura(const std::vector<Jar> &initial_jars);
+    void busca_largura_paralela(const std::vector<Jar> &initial_jars, int threads);
+    void busca_largura_externa(const std::vector<Jar> &initial_jars, const std::string &dir, size_t ram_budget);
     void busca_ordenada(const std::vector<Jar> &initial_jars);
     void busca_gulosa(const std::vector<Jar> &initial_jars);
     GameState solve_with_backtracking(const std::vector<Jar> &initial_jars);
     void solve_with_astar(const std::vector<Jar> &initial_jars);
+    void solve_with_ara_star(const std::vector<Jar> &initial_jars);
+    void solve_with_sma_star(const std::vector<Jar> &initial_jars);
+    void solve_with_hda_star(const std::vector<Jar> &initial_jars, int threads);
     void solve_with_ida_star(const std::vector<Jar> &initial_jars);
+    void solve_with_parallel_ida_star(const std::vector<Jar> &initial_jars, int threads);
+    void solve_with_distance_table(const std::vector<Jar> &initial_jars);
 
-    void print() const {
-    int visited_count = 0;
-    int closed_count = 0;
-    std::unordered_set<int> unique_parents;
-    int goal_index = -1;
-    int depth = 0;
-    int goal_g_cost = 0;
-
-    // Find the first goal state
-    for (size_t i = 0; i < states.size(); ++i) {
-        const GameState& s = states[i];
-        if (s.is_goal() && goal_index == -1) { // Only set if no goal was found yet
-            std::cout << "Goal state found at index: " << i << "   Key:" << s.to_key() << "\n";
-            goal_index = i;
-            goal_g_cost = s.g_cost;
-        }
-        
-        if (s.visited) visited_count++;
-        if (s.closed) closed_count++;
-        if (s.parent != -1) unique_parents.insert(s.parent); // -1 = root node, not counted
+    // The heuristic_kind bound for an instance, for the searches that use one
+    JarHeuristic search_heuristic(const std::vector<Jar> &jars);
+
+    // Goal node of the last search, or -1
+    int find_goal() const { return medidas.indiceObjetivo; }
+
+    // Number of actions from the root to node `index`
+    int path_depth(int index) const {
+        int depth = 0;
+        for (int i = nodes.parent(index); i != -1; i = nodes.parent(i)) ++depth;
+        return depth;
     }
 
-    // If no goal state found, use the last state
-    if (goal_index == -1 && !states.empty()) {
-        goal_index = states.size() - 1;
-        goal_g_cost = states[goal_index].g_cost;
+    // Drops the last search's nodes and rewinds the arena in O(1)
+    void release() {
+        nodes.clear();
+        memory.release();
     }
 
-    // Calculate depth by tracing parents to root
-    if (goal_index != -1) {
-        int current_index = goal_index;
-        while (current_index != -1 && current_index < static_cast<int>(states.size())) {
-            depth++;
-            current_index = states[current_index].parent;
-        }
-        // Adjust depth if root was reached (root has parent -1, so depth includes root)
-        if (current_index == -1) {
-            depth--; // Subtract 1 to exclude the root node from depth count
-        }
+    // Called by the searches when they start
+    void begin_search() {
+        release();
+        medidas.reiniciar();
+        progress.reset();
+    }
+
+    // Called by the searches when they finish: records the goal node (-1 if
+    // none) with its depth and cost, and the memory the search took
+    void record_goal(int goal) {
+        progress.finish();
+        medidas.bytesArena = memory.bytes_used();
+        medidas.picoBytesArena = memory.peak_bytes();
+        medidas.indiceObjetivo = goal;
+        medidas.profundidadeMax = goal == -1 ? 0 : path_depth(goal);
+        medidas.custoCaminho = goal == -1 ? 0 : nodes.g_cost(goal);
+        if (goal != -1) progress.improve_best(medidas.custoCaminho);
     }
 
-    std::cout << "-- Summary ---\n";
-    std::cout << "Visited states: " << visited_count - 1 << "\n";
-    std::cout << "Closed states: " << closed_count - 1 << "\n";
-    std::cout << "Expanded (unique parent IDs): " << unique_parents.size() << "\n";
-    std::cout << "Total states: " << states.size() << "\n";
-    std::cout << "Depth of goal (or last state): " << depth << "\n";
-    std::cout << "Path cost (g_cost): " << goal_g_cost << "\n";
-}
+    void print() const {
+        int goal_index = medidas.indiceObjetivo;
+        int depth = medidas.profundidadeMax;
+        int goal_g_cost = medidas.custoCaminho;
+        if (goal_index != -1) {
+            std::cout << "Goal state found at index: " << goal_index << "   Key:" << nodes.to_key(goal_index) << "\n";
+        } else if (!nodes.empty()) {
+            // No goal: report the last state
+            depth = path_depth(nodes.size() - 1);
+            goal_g_cost = nodes.g_cost(nodes.size() - 1);
+        }
 
+        std::cout << "-- Summary ---\n";
+        if (MedidasBusca::kAtivas) {
+            std::cout << "Generated states: " << medidas.totalFilhosGerados << "\n";
+            std::cout << "Expanded states: " << medidas.nosExpandidos << "\n";
+            std::cout << "Duplicate hits: " << medidas.duplicados << "\n";
+        }
+        std::cout << "Total states: " << nodes.size() << "\n";
+        std::cout << "Depth of goal (or last state): " << depth << "\n";
+        std::cout << "Path cost (g_cost): " << goal_g_cost << "\n";
+        std::cout << "Search memory: " << medidas.bytesArena << " bytes (peak " << medidas.picoBytesArena << ")\n";
+    }
 };
 
 #endif // SEARCH_ALGORITHMS_HPP
\ No newline at end of file
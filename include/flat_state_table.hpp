@@ -0,0 +1,184 @@
+#ifndef FLAT_STATE_TABLE_HPP
+#define FLAT_STATE_TABLE_HPP
+
+#include "medidasBuscas.hpp"
+#include "packed_state.hpp"
+#include "search_memory.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Open-addressing hash table keyed by PackedState (Robin Hood linear probing).
+// Values are stored inline next to the key, typically a state index or a g-cost.
+// The slots come from `memory` when one is given, the heap otherwise.
+template <typename V = int>
+class FlatStateTable {
+public:
+    explicit FlatStateTable(size_t expected = 0, SearchMemory* memory = nullptr)
+        : slots(ArenaAllocator<Slot>(memory)), count(0), mask(0), counting(false), lookups(0), probes(0) {
+        reserve(expected);
+    }
+
+    // Probe statistics of find/insert, off by default. Only for tables that a
+    // single thread reads, the counters are not atomic.
+    void count_probes(bool on) { counting = on; }
+    uint64_t probe_lookups() const { return lookups; }
+    uint64_t probe_steps() const { return probes; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return slots.size(); }
+
+    void clear() {
+        for (size_t i = 0; i < slots.size(); ++i) slots[i].dist = 0;
+        count = 0;
+    }
+
+    // Grows the table so that `expected` entries fit below the max load factor
+    void reserve(size_t expected) {
+        size_t wanted = slots_for(expected);
+        if (wanted > slots.size()) rehash(wanted);
+    }
+
+    // Bytes of the slot array of a table reserved for `expected` entries
+    static size_t reserved_bytes(size_t expected) { return slots_for(expected) * sizeof(Slot); }
+
+    V* find(const PackedState& key) {
+        size_t pos = find_index(key);
+        return pos == kNotFound ? nullptr : &slots[pos].value;
+    }
+
+    const V* find(const PackedState& key) const {
+        return const_cast<FlatStateTable*>(this)->find(key);
+    }
+
+    bool contains(const PackedState& key) const { return find(key) != nullptr; }
+
+    // Inserts key -> value if absent. Returns the stored value and whether it was inserted.
+    std::pair<V*, bool> emplace(const PackedState& key, const V& value) {
+        V* existing = find(key);
+        if (existing) return std::make_pair(existing, false);
+        if ((count + 1) * kMaxLoadDen > slots.size() * kMaxLoadNum) rehash(slots.size() * 2);
+        return std::make_pair(place(key, value), true);
+    }
+
+    bool insert(const PackedState& key, const V& value = V()) {
+        return emplace(key, value).second;
+    }
+
+    V& operator[](const PackedState& key) {
+        return *emplace(key, V()).first;
+    }
+
+    // Backward-shift deletion keeps probe sequences short without tombstones
+    bool erase(const PackedState& key) {
+        size_t pos = find_index(key);
+        if (pos == kNotFound) return false;
+        size_t next = (pos + 1) & mask;
+        while (slots[next].dist > 1) {
+            slots[pos] = slots[next];
+            slots[pos].dist--;
+            pos = next;
+            next = (next + 1) & mask;
+        }
+        slots[pos].dist = 0;
+        --count;
+        return true;
+    }
+
+    template <typename F>
+    void for_each(F f) const {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (slots[i].dist) f(slots[i].key, slots[i].value);
+        }
+    }
+
+private:
+    struct Slot {
+        PackedState key;
+        V value;
+        uint32_t dist; // 0 = empty, otherwise probe distance + 1
+        Slot() : value(), dist(0) {}
+    };
+
+    static const size_t kMaxLoadNum = 7; // max load factor 7/8
+    static const size_t kMaxLoadDen = 8;
+
+    static const size_t kNotFound = static_cast<size_t>(-1);
+
+    static size_t slots_for(size_t expected) {
+        size_t wanted = 16;
+        while (wanted * kMaxLoadNum < expected * kMaxLoadDen) wanted <<= 1;
+        return wanted;
+    }
+
+    ArenaVector<Slot> slots;
+    size_t count;
+    size_t mask;
+    bool counting;
+    mutable uint64_t lookups;
+    mutable uint64_t probes;
+
+    size_t find_index(const PackedState& key) const {
+        if (count == 0) return kNotFound;
+        size_t pos = PackedStateHash()(key) & mask;
+        uint32_t dist = 1;
+        while (true) {
+            const Slot& s = slots[pos];
+            if (s.dist < dist || s.key == key) {
+                if (WATER_JUG_STATS && counting) {
+                    ++lookups;
+                    probes += dist;
+                }
+                // a resident closer to its home means key is absent
+                return s.dist < dist ? kNotFound : pos;
+            }
+            pos = (pos + 1) & mask;
+            ++dist;
+        }
+    }
+
+    V* place(PackedState key, V value) {
+        size_t pos = PackedStateHash()(key) & mask;
+        uint32_t dist = 1;
+        V* result = nullptr;
+        while (true) {
+            Slot& s = slots[pos];
+            if (s.dist == 0) {
+                s.key = key;
+                s.value = value;
+                s.dist = dist;
+                ++count;
+                return result ? result : &s.value;
+            }
+            if (s.dist < dist) {
+                // Robin Hood: the richer resident moves on, the poorer entry takes the slot
+                std::swap(s.key, key);
+                std::swap(s.value, value);
+                std::swap(s.dist, dist);
+                if (!result) result = &s.value;
+            }
+            pos = (pos + 1) & mask;
+            ++dist;
+        }
+    }
+
+    void rehash(size_t new_capacity) {
+        ArenaVector<Slot> old(slots.get_allocator());
+        old.swap(slots);
+        slots.resize(new_capacity);
+        mask = new_capacity - 1;
+        count = 0;
+        for (size_t i = 0; i < old.size(); ++i) {
+            if (old[i].dist) place(old[i].key, old[i].value);
+        }
+    }
+};
+
+// Initial table size for a search: the whole state space when small, capped otherwise
+inline size_t table_estimate(const StateCodec& codec, size_t cap = 1 << 16) {
+    return codec.state_count() < cap ? static_cast<size_t>(codec.state_count()) : cap;
+}
+
+#endif // FLAT_STATE_TABLE_HPP
@@ -0,0 +1,191 @@
+#ifndef IDA_PATH_HPP
+#define IDA_PATH_HPP
+
+#include "flat_state_table.hpp"
+#include "jar_kernel.hpp"
+#include "medidasBuscas.hpp"
+#include "node_arena.hpp"
+#include "packed_state.hpp"
+#include "search_memory.hpp"
+#include "search_progress.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+// Cost-bounded depth-first search that only keeps the current path: one frame
+// per depth with the state, its key, g and the next action to try. Cycles are
+// detected against the keys on the path. The stack keeps its memory between
+// calls and only grows when a deeper path is needed, in `memory` if given.
+//
+// Optionally a bounded transposition table prunes states already reached with
+// a smaller or equal g in the same iteration; the caller clears it between
+// iterations.
+template <class Kernel>
+class IdaPath {
+public:
+    enum Result { FOUND, EXHAUSTED, STOPPED };
+
+    MedidasBusca stats; // accumulated over every search() call
+
+    IdaPath(const Kernel& k, const StateCodec& c, SearchMemory* memory = nullptr)
+        : kernel(k), codec(c), n(k.num_jars()), top(-1), base(-1), frames(ArenaAllocator<Frame>(memory)),
+          states(ArenaAllocator<uint16_t>(memory)), seen(nullptr), seen_limit(0), progress(nullptr), pushed(0) {}
+
+    // Reports expansions (and the path length as frontier) to `p`, nullptr to disable.
+    // Several searchers may share one SearchProgress.
+    void set_progress(SearchProgress* p) { progress = p; }
+    // Adds the expansions not reported yet, once the searches are over
+    void finish_progress() {
+        if (!progress) return;
+        progress->add_expansions(pushed % SearchProgress::kPublishEvery);
+        pushed -= pushed % SearchProgress::kPublishEvery;
+    }
+
+    // Uses `table` (nullptr to disable) for up to `limit` states
+    void set_transpositions(FlatStateTable<int>* table, size_t limit) {
+        seen = table;
+        seen_limit = limit;
+    }
+
+    // Starts from a path prefix: `len` states of n values each with their g-costs
+    void start(const uint16_t* values, const int* g, int len) {
+        reserve(len);
+        for (int d = 0; d < len; ++d) {
+            for (int j = 0; j < n; ++j) states[d * n + j] = values[d * n + j];
+            frames[d].g = g[d];
+            frames[d].cursor = kernel.num_actions();
+            frames[d].key = codec.encode(&states[d * n]);
+            frames[d].terms = kernel.heuristic_terms(&states[d * n]);
+        }
+        top = len - 1;
+        base = top;
+        frames[top].cursor = 0;
+    }
+
+    // Explores the subtree below the prefix up to f <= threshold. On EXHAUSTED,
+    // `next` holds the smallest f above the threshold (INT_MAX if none); on
+    // FOUND the path ends at a goal. `stop` is polled every few expansions.
+    Result search(int threshold, int& next, const std::atomic<bool>* stop = nullptr) {
+        next = INT_MAX;
+        const uint16_t* root = &states[top * n];
+        int root_f = frames[top].g + kernel.heuristic(root);
+        if (root_f > threshold) {
+            next = root_f;
+            return EXHAUSTED;
+        }
+        if (kernel.is_goal(root)) return FOUND;
+        stats.expandiu();
+
+        const int num_actions = kernel.num_actions();
+        unsigned polls = 0;
+        while (top >= base) {
+            if (stop && (++polls & 1023) == 0 && stop->load(std::memory_order_relaxed)) return STOPPED;
+
+            if (frames[top].cursor == num_actions) {
+                --top;
+                continue;
+            }
+            reserve(top + 2);
+            const uint16_t* parent = &states[top * n];
+            uint16_t* child = &states[(top + 1) * n];
+            for (int j = 0; j < n; ++j) child[j] = parent[j];
+            int k = frames[top].cursor++;
+            int cost = kernel.apply_action(k, parent, child);
+            if (!cost) continue;
+            stats.gerou();
+
+            int g = frames[top].g + cost;
+            const JarAction& action = kernel.action(k);
+            int f = g + kernel.child_heuristic(frames[top].terms, parent, child, action.jar, action.type);
+            if (f > threshold) {
+                if (f < next) next = f;
+                continue;
+            }
+            PackedState key = codec.encode(child);
+            if (on_path(key) || transposed(key, g)) {
+                stats.duplicado();
+                continue;
+            }
+
+            ++top;
+            frames[top].g = g;
+            frames[top].cursor = 0;
+            frames[top].key = key;
+            frames[top].terms = kernel.heuristic_terms(child);
+            stats.abertos(top + 1);
+            if (progress && ++pushed % SearchProgress::kPublishEvery == 0) {
+                progress->add_expansions(SearchProgress::kPublishEvery);
+                progress->set_frontier(top + 1);
+            }
+            if (kernel.is_goal(child)) return FOUND;
+            stats.expandiu();
+        }
+        return EXHAUSTED;
+    }
+
+    // Current path (after FOUND: root .. goal)
+    int depth() const { return top + 1; }
+    const uint16_t* values(int d) const { return &states[d * n]; }
+    int g_cost(int d) const { return frames[d].g; }
+
+    // Appends the current path to the arena, each node the parent of the next
+    void store(NodeArena& nodes) const {
+        int first = nodes.size();
+        for (int d = 0; d <= top; ++d) {
+            const uint16_t* v = &states[d * n];
+            int idx = nodes.add(v, d == 0 ? -1 : first + d - 1, frames[d].g, frames[d].g + kernel.heuristic(v));
+            nodes.set_visited(idx);
+            if (d < top) nodes.set_closed(idx);
+        }
+    }
+
+private:
+    struct Frame {
+        PackedState key;
+        int g;
+        int cursor;
+        JarHeuristicTerms terms; // for the children's heuristic
+    };
+
+    const Kernel& kernel;
+    const StateCodec& codec;
+    int n;
+    int top;
+    int base;
+    ArenaVector<Frame> frames;
+    ArenaVector<uint16_t> states;
+    FlatStateTable<int>* seen;
+    size_t seen_limit;
+    SearchProgress* progress;
+    uint64_t pushed;
+
+    void reserve(int len) {
+        if (static_cast<int>(frames.size()) >= len) return;
+        size_t size = std::max(static_cast<size_t>(len), frames.size() * 2);
+        frames.resize(size);
+        states.resize(size * n);
+    }
+
+    bool transposed(const PackedState& key, int g) {
+        if (!seen) return false;
+        int* best = seen->find(key);
+        if (best) {
+            if (*best <= g) return true;
+            *best = g;
+        } else if (seen->size() < seen_limit) {
+            seen->insert(key, g);
+        }
+        return false;
+    }
+
+    bool on_path(const PackedState& key) const {
+        for (int d = top; d >= 0; --d) {
+            if (frames[d].key == key) return true;
+        }
+        return false;
+    }
+};
+
+#endif // IDA_PATH_HPP
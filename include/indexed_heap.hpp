@@ -0,0 +1,102 @@
+#ifndef INDEXED_HEAP_HPP
+#define INDEXED_HEAP_HPP
+
+#include "search_memory.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Binary heap of non-negative integer items (node indices) that knows where
+// each item sits, so an item can be removed or moved after its key changed
+// (decrease-key) in O(log n) instead of leaving a stale copy behind. The keys
+// live outside: Before(a, b) is true when item a must come out before b.
+template <class Before>
+class IndexedHeap {
+public:
+    explicit IndexedHeap(Before b, SearchMemory* memory = nullptr)
+        : before(b), heap(ArenaAllocator<int>(memory)), pos(ArenaAllocator<int>(memory)) {}
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    bool contains(int item) const { return item < static_cast<int>(pos.size()) && pos[item] != -1; }
+    int top() const { return heap.front(); }
+
+    // Sizes the position table for items below `items` up front
+    void reserve(size_t items) {
+        if (items > pos.size()) pos.resize(items, -1);
+        heap.reserve(items);
+    }
+
+    void push(int item) {
+        if (item >= static_cast<int>(pos.size())) pos.resize(std::max(static_cast<size_t>(item) + 1, pos.size() * 2), -1);
+        heap.push_back(item);
+        pos[item] = static_cast<int>(heap.size()) - 1;
+        sift_up(heap.size() - 1);
+    }
+
+    int pop() {
+        int item = heap.front();
+        erase(item);
+        return item;
+    }
+
+    void erase(int item) {
+        size_t i = pos[item];
+        pos[item] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (i == heap.size()) return;
+        place(i, last);
+        resift(i);
+    }
+
+    // Restores the order after the key of `item` changed, in either direction
+    void update(int item) { resift(pos[item]); }
+
+    void clear() {
+        for (size_t i = 0; i < heap.size(); ++i) pos[heap[i]] = -1;
+        heap.clear();
+    }
+
+private:
+    Before before;
+    ArenaVector<int> heap;
+    ArenaVector<int> pos; // -1 when not in the heap
+
+    void place(size_t i, int item) {
+        heap[i] = item;
+        pos[item] = static_cast<int>(i);
+    }
+
+    void resift(size_t i) {
+        if (i > 0 && before(heap[i], heap[(i - 1) / 2])) sift_up(i);
+        else sift_down(i);
+    }
+
+    void sift_up(size_t i) {
+        int item = heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!before(item, heap[parent])) break;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, item);
+    }
+
+    void sift_down(size_t i) {
+        int item = heap[i];
+        size_t n = heap.size();
+        while (true) {
+            size_t child = 2 * i + 1;
+            if (child >= n) break;
+            if (child + 1 < n && before(heap[child + 1], heap[child])) ++child;
+            if (!before(heap[child], item)) break;
+            place(i, heap[child]);
+            i = child;
+        }
+        place(i, item);
+    }
+};
+
+#endif // INDEXED_HEAP_HPP
@@ -0,0 +1,39 @@
+#ifndef INSTANCE_GENERATOR_HPP
+#define INSTANCE_GENERATOR_HPP
+
+#include "structure.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Random water jug instances with reproducible output for a given seed
+struct InstanceParams {
+    int jars = 4;
+    int min_capacity = 2;
+    int max_capacity = 9;
+    bool random_fill = false;     // random initial values instead of empty jars
+    bool solvable_only = false;   // skip instances whose goal is not reachable
+    uint64_t max_states = 1 << 22; // state budget of the solvability check
+    uint64_t seed = 1;
+};
+
+class InstanceGenerator {
+public:
+    explicit InstanceGenerator(const InstanceParams& params);
+
+    // Returns false if no acceptable instance was found in a bounded number of draws
+    bool next(std::vector<Jar>& jars);
+
+private:
+    InstanceParams params;
+    std::mt19937_64 rng;
+
+    void draw(std::vector<Jar>& jars);
+};
+
+// Breadth-first reachability check without storing nodes. Instances with more
+// than `max_states` states, or that the search kernels cannot handle, count
+// as not solvable.
+bool instance_solvable(const std::vector<Jar>& jars, uint64_t max_states);
+
+#endif // INSTANCE_GENERATOR_HPP
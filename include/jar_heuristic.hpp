@@ -0,0 +1,186 @@
+#ifndef JAR_HEURISTIC_HPP
+#define JAR_HEURISTIC_HPP
+
+#include "pattern_database.hpp"
+#include "structure.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Lower bounds on the cost still to pay, i.e. the water still to move.
+// Steps is GameState::heuristic; volume and adjacent are exact costs of a
+// relaxation where water moves one unit at a time at a cost of 1 per unit:
+// filled or emptied anywhere, or poured into a neighbouring jar. A real
+// action is a sequence of such moves with the same total cost, so these
+// bounds are admissible and consistent. So is the pattern database, see
+// pattern_database.hpp.
+enum HeuristicKind {
+    HEURISTIC_STEPS,    // max(total, largest) deviation from target_Q over the largest capacity
+    HEURISTIC_VOLUME,   // max(total excess, total deficit): a unit moved fixes at most one of each
+    HEURISTIC_ADJACENT, // excess + deficit, less what neighbouring jars can pour into each other
+    HEURISTIC_PDB       // pattern database over windows of adjacent jars, at least the adjacent bound
+};
+
+const char* heuristic_name(HeuristicKind kind);
+bool parse_heuristic(const std::string& name, HeuristicKind& kind);
+
+// Same estimate as GameState::heuristic
+inline int jar_heuristic(int current_sum, int max_individual_diff, int target_sum, int max_cap) {
+    int sum_diff = std::abs(current_sum - target_sum);
+    int sum_adjust_steps = (sum_diff + max_cap - 1) / max_cap;
+    int individual_adjust_steps = (max_individual_diff + max_cap - 1) / max_cap;
+    return sum_adjust_steps > individual_adjust_steps ? sum_adjust_steps : individual_adjust_steps;
+}
+
+// The parts of the heuristic of one state, kept so that the heuristic of each
+// child follows in O(1): an action changes at most two jars, so the largest
+// deviation among the untouched jars is one of the parent's three largest.
+// The adjacent bound follows from the parent's by rescoring the run of jars
+// around the change that trade water with each other.
+struct JarHeuristicTerms {
+    int sum;
+    int excess;      // water above target_Q, over all jars
+    int deficit;     // water missing below target_Q
+    int top_diff[3]; // three largest |value - target|, descending
+    int top_jar[3];  // their jars, -1 past the last jar
+    int adjacent;    // adjacent bound, for HEURISTIC_ADJACENT and HEURISTIC_PDB
+};
+
+// One heuristic of the family, bound to an instance. Small and copyable:
+// every kernel holds its own. HEURISTIC_PDB takes the database built for the
+// instance's capacities and is the adjacent bound without one.
+class JarHeuristic {
+public:
+    JarHeuristic(const std::vector<Jar>& jars, HeuristicKind k = HEURISTIC_STEPS,
+                 std::shared_ptr<const PatternDatabase> database = nullptr)
+        : which(k), n(static_cast<int>(jars.size())), target(jars.empty() ? 0 : jars[0].max_capacity), max_cap(1),
+          pdb(std::move(database)) {
+        for (const Jar& jar : jars) {
+            target = std::min(target, jar.max_capacity);
+            max_cap = std::max(max_cap, jar.max_capacity);
+        }
+    }
+
+    HeuristicKind kind() const { return which; }
+    // Every kind is consistent today; A* reopens closed nodes for one that is not
+    bool consistent() const { return true; }
+
+    int estimate(const uint16_t* v) const {
+        if (which == HEURISTIC_PDB) return pdb ? std::max(pdb->estimate(v), adjacent_bound(v)) : adjacent_bound(v);
+        if (which == HEURISTIC_ADJACENT) return adjacent_bound(v);
+        return from_terms(terms(v));
+    }
+
+    JarHeuristicTerms terms(const uint16_t* v) const {
+        JarHeuristicTerms t = {0, 0, 0, {0, 0, 0}, {-1, -1, -1}, 0};
+        for (int j = 0; j < n; ++j) {
+            t.sum += v[j];
+            int d = static_cast<int>(v[j]) - target;
+            if (d > 0) t.excess += d;
+            else t.deficit -= d;
+            int diff = std::abs(d);
+            int k = 3;
+            while (k > 0 && (t.top_jar[k - 1] == -1 || diff > t.top_diff[k - 1])) --k;
+            if (k == 3) continue;
+            for (int m = 2; m > k; --m) {
+                t.top_diff[m] = t.top_diff[m - 1];
+                t.top_jar[m] = t.top_jar[m - 1];
+            }
+            t.top_diff[k] = diff;
+            t.top_jar[k] = j;
+        }
+        if (which >= HEURISTIC_ADJACENT) t.adjacent = adjacent_bound(v);
+        return t;
+    }
+
+    // Estimate of `child`, which differs from the state of `t` (`parent`) in
+    // `jar` and, for a transfer, in `other` (-1 otherwise)
+    int child_estimate(const JarHeuristicTerms& t, const uint16_t* parent, const uint16_t* child, int jar, int other) const {
+        if (which == HEURISTIC_ADJACENT) return adjacent_child(t, parent, child, jar, other);
+        if (which == HEURISTIC_PDB) {
+            int adjacent = adjacent_child(t, parent, child, jar, other);
+            return pdb ? std::max(pdb->estimate(child), adjacent) : adjacent;
+        }
+        JarHeuristicTerms c = t;
+        touch(c, parent[jar], child[jar]);
+        if (other != -1) touch(c, parent[other], child[other]);
+
+        int max_diff = std::abs(static_cast<int>(child[jar]) - target);
+        if (other != -1) max_diff = std::max(max_diff, std::abs(static_cast<int>(child[other]) - target));
+        for (int k = 0; k < 3; ++k) {
+            if (t.top_jar[k] != jar && t.top_jar[k] != other) {
+                if (t.top_jar[k] != -1) max_diff = std::max(max_diff, t.top_diff[k]);
+                break;
+            }
+        }
+        c.top_diff[0] = max_diff;
+        return from_terms(c);
+    }
+
+private:
+    HeuristicKind which;
+    int n;
+    int target;
+    int max_cap;
+    std::shared_ptr<const PatternDatabase> pdb;
+
+    // Uses sum/excess/deficit and top_diff[0] only
+    int from_terms(const JarHeuristicTerms& t) const {
+        if (which == HEURISTIC_VOLUME) return std::max(t.excess, t.deficit);
+        return jar_heuristic(t.sum, t.top_diff[0], target * n, max_cap);
+    }
+
+    void touch(JarHeuristicTerms& t, int before, int after) const {
+        t.sum += after - before;
+        int d0 = before - target;
+        int d1 = after - target;
+        t.excess += std::max(d1, 0) - std::max(d0, 0);
+        t.deficit += std::max(-d1, 0) - std::max(-d0, 0);
+    }
+
+    // Pouring one unit between neighbours fixes an excess and a deficit for
+    // the price of emptying or filling one of them; farther apart it saves
+    // nothing. Neighbours of opposite sign form chains along the row, where
+    // pairing greedily from the left trades the most water.
+    int adjacent_bound(const uint16_t* v) const { return adjacent_run(v, 0, n - 1); }
+
+    // The bound restricted to jars first .. last, as if they were the whole row
+    int adjacent_run(const uint16_t* v, int first, int last) const {
+        int total = 0;
+        int traded = 0;
+        int carry = 0; // deviation of the previous jar left after its own trade
+        for (int j = first; j <= last; ++j) {
+            int d = static_cast<int>(v[j]) - target;
+            total += std::abs(d);
+            if ((carry > 0 && d < 0) || (carry < 0 && d > 0)) {
+                int amount = std::min(std::abs(carry), std::abs(d));
+                traded += amount;
+                d += d > 0 ? -amount : amount;
+            }
+            carry = d;
+        }
+        return total - traded;
+    }
+
+    // Jars j - 1 and j trade no water: their deviations are not of opposite signs
+    bool chain_break(const uint16_t* v, int j) const {
+        int a = static_cast<int>(v[j - 1]) - target;
+        int b = static_cast<int>(v[j]) - target;
+        return (a >= 0 && b >= 0) || (a <= 0 && b <= 0);
+    }
+
+    // Only the chains through the changed jars differ from the parent's: widen
+    // the changed range to breaks that hold in both states and rescore it
+    int adjacent_child(const JarHeuristicTerms& t, const uint16_t* parent, const uint16_t* child, int jar, int other) const {
+        int first = other == -1 ? jar : std::min(jar, other);
+        int last = other == -1 ? jar : std::max(jar, other);
+        while (first > 0 && !(chain_break(parent, first) && chain_break(child, first))) --first;
+        while (last + 1 < n && !(chain_break(parent, last + 1) && chain_break(child, last + 1))) ++last;
+        return t.adjacent - adjacent_run(parent, first, last) + adjacent_run(child, first, last);
+    }
+};
+
+#endif // JAR_HEURISTIC_HPP
@@ -0,0 +1,325 @@
+#ifndef JAR_KERNEL_HPP
+#define JAR_KERNEL_HPP
+
+#include "jar_heuristic.hpp"
+#include "structure.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Action codes, same numbering as GameState::calculate_action_cost
+enum JarActionType {
+    ACTION_EMPTY = 0,
+    ACTION_FILL = 1,
+    ACTION_TRANSFER_LEFT = 2,
+    ACTION_TRANSFER_RIGHT = 3
+};
+
+struct JarAction {
+    int jar;
+    int type;
+};
+
+// Kernels work on uint16_t jar values
+inline bool kernel_supports(const std::vector<Jar>& jars) {
+    for (const Jar& jar : jars) {
+        if (jar.max_capacity <= 0 || jar.max_capacity > 0xFFFF) return false;
+        if (jar.current_value < 0 || jar.current_value > jar.max_capacity) return false;
+    }
+    return !jars.empty();
+}
+
+// Applies one action to `child`, which must hold the same values as `parent`.
+// Returns the water moved (the action cost), or 0 if the action does not apply.
+inline int apply_jar_action(const uint16_t* caps, const uint16_t* parent, uint16_t* child, int jar, int type) {
+    switch (type) {
+        case ACTION_EMPTY:
+            if (parent[jar] == 0) return 0;
+            child[jar] = 0;
+            return parent[jar];
+        case ACTION_FILL:
+            if (parent[jar] == caps[jar]) return 0;
+            child[jar] = caps[jar];
+            return caps[jar] - parent[jar];
+        default: {
+            int dst = (type == ACTION_TRANSFER_LEFT) ? jar - 1 : jar + 1;
+            int space = caps[dst] - parent[dst];
+            int amount = parent[jar] < space ? parent[jar] : space;
+            if (amount == 0) return 0;
+            child[jar] = static_cast<uint16_t>(parent[jar] - amount);
+            child[dst] = static_cast<uint16_t>(parent[dst] + amount);
+            return amount;
+        }
+    }
+}
+
+// Second jar an action changes: the destination of a transfer, -1 otherwise
+inline int transfer_target(int jar, int type) {
+    if (type == ACTION_TRANSFER_LEFT) return jar - 1;
+    if (type == ACTION_TRANSFER_RIGHT) return jar + 1;
+    return -1;
+}
+
+// Undoes apply_jar_action on `child` by copying back the touched jars
+inline void restore_jar_action(const uint16_t* parent, uint16_t* child, int jar, int type) {
+    child[jar] = parent[jar];
+    if (type == ACTION_TRANSFER_LEFT) child[jar - 1] = parent[jar - 1];
+    else if (type == ACTION_TRANSFER_RIGHT) child[jar + 1] = parent[jar + 1];
+}
+
+// Compile-time index sequence (std::index_sequence is C++14)
+template <int... I> struct IndexSeq {};
+template <int K, int... I> struct MakeIndexSeq : MakeIndexSeq<K - 1, K - 1, I...> {};
+template <int... I> struct MakeIndexSeq<0, I...> { typedef IndexSeq<I...> type; };
+
+// Valid actions in jar-major order. The only structurally invalid raw actions
+// are "transfer left" on jar 0 (raw index 2) and "transfer right" on the last
+// jar (the last raw index), so the k-th valid action does not depend on N.
+constexpr int action_jar(int k) { return (k < 2 ? k : k + 1) / 4; }
+constexpr int action_type(int k) { return (k < 2 ? k : k + 1) % 4; }
+
+template <int N, class Seq = typename MakeIndexSeq<4 * N - 2>::type>
+struct ActionTable;
+
+template <int N, int... K>
+struct ActionTable<N, IndexSeq<K...>> {
+    static constexpr int kCount = sizeof...(K);
+    static constexpr JarAction actions[kCount] = { JarAction{action_jar(K), action_type(K)}... };
+};
+
+template <int N, int... K>
+constexpr JarAction ActionTable<N, IndexSeq<K...>>::actions[];
+
+template <int N, int K, int End>
+struct UnrolledActions {
+    template <class F>
+    static void run(const uint16_t* caps, const uint16_t* parent, uint16_t* child, F& visit) {
+        const int jar = action_jar(K);
+        const int type = action_type(K);
+        int cost = apply_jar_action(caps, parent, child, jar, type);
+        if (cost) {
+            visit(static_cast<const uint16_t*>(child), cost, jar, type);
+            restore_jar_action(parent, child, jar, type);
+        }
+        UnrolledActions<N, K + 1, End>::run(caps, parent, child, visit);
+    }
+};
+
+template <int N, int End>
+struct UnrolledActions<N, End, End> {
+    template <class F>
+    static void run(const uint16_t*, const uint16_t*, uint16_t*, F&) {}
+};
+
+// Successor generation and heuristic for an instance with exactly N jars.
+// State is a std::array, every loop has a compile-time trip count.
+template <int N>
+class FixedJarKernel {
+public:
+    typedef std::array<uint16_t, N> State;
+    static const int kNumJars = N;
+
+    explicit FixedJarKernel(const std::vector<Jar>& jars) : FixedJarKernel(jars, JarHeuristic(jars)) {}
+    FixedJarKernel(const std::vector<Jar>& jars, const JarHeuristic& heuristic) : h(heuristic), target_Q(0), max_cap(0) {
+        int min_cap = jars[0].max_capacity;
+        for (int j = 0; j < N; ++j) {
+            caps[j] = static_cast<uint16_t>(jars[j].max_capacity);
+            initial[j] = static_cast<uint16_t>(jars[j].current_value);
+            min_cap = std::min(min_cap, jars[j].max_capacity);
+            max_cap = std::max(max_cap, jars[j].max_capacity);
+        }
+        target_Q = min_cap;
+    }
+
+    int num_jars() const { return N; }
+    int target() const { return target_Q; }
+    int max_capacity() const { return max_cap; }
+    const uint16_t* capacities() const { return caps.data(); }
+
+    State make_state() const { State s; s.fill(0); return s; }
+    State initial_state() const { return initial; }
+
+    bool is_goal(const uint16_t* v) const {
+        for (int j = 0; j < N; ++j) {
+            if (v[j] != target_Q) return false;
+        }
+        return true;
+    }
+
+    int heuristic(const uint16_t* v) const { return h.estimate(v); }
+    bool heuristic_consistent() const { return h.consistent(); }
+
+    // Incremental form: terms of a state once per expansion, then O(1) per child
+    JarHeuristicTerms heuristic_terms(const uint16_t* v) const { return h.terms(v); }
+    int child_heuristic(const JarHeuristicTerms& t, const uint16_t* parent, const uint16_t* child, int jar, int type) const {
+        return h.child_estimate(t, parent, child, jar, transfer_target(jar, type));
+    }
+
+    // Actions one at a time, for searches that keep a cursor per frame.
+    // `child` must hold the parent's values; returns the cost, 0 if not applicable.
+    int num_actions() const { return ActionTable<N>::kCount; }
+    const JarAction& action(int k) const { return ActionTable<N>::actions[k]; }
+    int apply_action(int k, const uint16_t* parent, uint16_t* child) const {
+        const JarAction& a = ActionTable<N>::actions[k];
+        return apply_jar_action(caps.data(), parent, child, a.jar, a.type);
+    }
+
+    // Calls visit(child_values, cost, jar, type) for every applicable action.
+    // `child` is scratch space of N values, only valid during the callback.
+    template <class F>
+    void for_each_successor(const uint16_t* parent, uint16_t* child, F visit) const {
+        for (int j = 0; j < N; ++j) child[j] = parent[j];
+        UnrolledActions<N, 0, ActionTable<N>::kCount>::run(caps.data(), parent, child, visit);
+    }
+
+private:
+    JarHeuristic h;
+    State caps;
+    State initial;
+    int target_Q;
+    int max_cap;
+};
+
+// Fallback for jar counts without a specialization
+class GenericJarKernel {
+public:
+    typedef std::vector<uint16_t> State;
+
+    explicit GenericJarKernel(const std::vector<Jar>& jars) : GenericJarKernel(jars, JarHeuristic(jars)) {}
+    GenericJarKernel(const std::vector<Jar>& jars, const JarHeuristic& heuristic)
+        : n(static_cast<int>(jars.size())), h(heuristic), target_Q(0), max_cap(0) {
+        int min_cap = jars[0].max_capacity;
+        caps.resize(n);
+        initial.resize(n);
+        for (int j = 0; j < n; ++j) {
+            caps[j] = static_cast<uint16_t>(jars[j].max_capacity);
+            initial[j] = static_cast<uint16_t>(jars[j].current_value);
+            min_cap = std::min(min_cap, jars[j].max_capacity);
+            max_cap = std::max(max_cap, jars[j].max_capacity);
+            for (int type = 0; type < 4; ++type) {
+                if (type == ACTION_TRANSFER_LEFT && j == 0) continue;
+                if (type == ACTION_TRANSFER_RIGHT && j == n - 1) continue;
+                JarAction a = {j, type};
+                actions.push_back(a);
+            }
+        }
+        target_Q = min_cap;
+    }
+
+    int num_jars() const { return n; }
+    int target() const { return target_Q; }
+    int max_capacity() const { return max_cap; }
+    const uint16_t* capacities() const { return caps.data(); }
+
+    State make_state() const { return State(n, 0); }
+    State initial_state() const { return initial; }
+
+    bool is_goal(const uint16_t* v) const {
+        for (int j = 0; j < n; ++j) {
+            if (v[j] != target_Q) return false;
+        }
+        return true;
+    }
+
+    int heuristic(const uint16_t* v) const { return h.estimate(v); }
+    bool heuristic_consistent() const { return h.consistent(); }
+
+    JarHeuristicTerms heuristic_terms(const uint16_t* v) const { return h.terms(v); }
+    int child_heuristic(const JarHeuristicTerms& t, const uint16_t* parent, const uint16_t* child, int jar, int type) const {
+        return h.child_estimate(t, parent, child, jar, transfer_target(jar, type));
+    }
+
+    int num_actions() const { return static_cast<int>(actions.size()); }
+    const JarAction& action(int k) const { return actions[k]; }
+    int apply_action(int k, const uint16_t* parent, uint16_t* child) const {
+        return apply_jar_action(caps.data(), parent, child, actions[k].jar, actions[k].type);
+    }
+
+    template <class F>
+    void for_each_successor(const uint16_t* parent, uint16_t* child, F visit) const {
+        for (int j = 0; j < n; ++j) child[j] = parent[j];
+        for (size_t k = 0; k < actions.size(); ++k) {
+            const JarAction& a = actions[k];
+            int cost = apply_jar_action(caps.data(), parent, child, a.jar, a.type);
+            if (cost) {
+                visit(static_cast<const uint16_t*>(child), cost, a.jar, a.type);
+                restore_jar_action(parent, child, a.jar, a.type);
+            }
+        }
+    }
+
+private:
+    int n;
+    JarHeuristic h;
+    State caps;
+    State initial;
+    std::vector<JarAction> actions;
+    int target_Q;
+    int max_cap;
+};
+
+// Children of one state, written by expand_successors. The storage only grows,
+// so a buffer reused across expansions stops allocating after the first ones.
+struct SuccessorBuffer {
+    std::vector<uint16_t> values; // count * jars values
+    std::vector<int> costs;
+    std::vector<JarAction> actions;
+    int jars;
+    int count;
+
+    SuccessorBuffer() : jars(0), count(0) {}
+
+    const uint16_t* child(int i) const { return &values[static_cast<size_t>(i) * jars]; }
+
+    void reserve(int num_jars, int max_children) {
+        jars = num_jars;
+        if (static_cast<int>(costs.size()) >= max_children && values.size() >= static_cast<size_t>(max_children) * jars) return;
+        values.resize(static_cast<size_t>(max_children) * jars);
+        costs.resize(max_children);
+        actions.resize(max_children);
+    }
+};
+
+// Writes every child of `parent` into `out`, in the same order as
+// for_each_successor, and returns how many there are
+template <class Kernel>
+int expand_successors(const Kernel& kernel, const uint16_t* parent, SuccessorBuffer& out) {
+    const int n = kernel.num_jars();
+    const int m = kernel.num_actions();
+    out.reserve(n, m);
+    out.count = 0;
+    for (int k = 0; k < m; ++k) {
+        uint16_t* child = &out.values[static_cast<size_t>(out.count) * n];
+        for (int j = 0; j < n; ++j) child[j] = parent[j];
+        int cost = kernel.apply_action(k, parent, child);
+        if (!cost) continue;
+        out.costs[out.count] = cost;
+        out.actions[out.count] = kernel.action(k);
+        ++out.count;
+    }
+    return out.count;
+}
+
+// Runs `run(kernel)` with the kernel specialized for jars.size(), falling back
+// to GenericJarKernel. `run` needs a templated operator()(const Kernel&).
+template <class Runner>
+void with_jar_kernel(const std::vector<Jar>& jars, const JarHeuristic& h, Runner& run) {
+    switch (jars.size()) {
+        case 3: run(FixedJarKernel<3>(jars, h)); break;
+        case 4: run(FixedJarKernel<4>(jars, h)); break;
+        case 5: run(FixedJarKernel<5>(jars, h)); break;
+        case 6: run(FixedJarKernel<6>(jars, h)); break;
+        case 7: run(FixedJarKernel<7>(jars, h)); break;
+        case 8: run(FixedJarKernel<8>(jars, h)); break;
+        default: run(GenericJarKernel(jars, h)); break;
+    }
+}
+
+// Same, with the kernels' default heuristic (GameState::heuristic)
+template <class Runner>
+void with_jar_kernel(const std::vector<Jar>& jars, Runner& run) {
+    with_jar_kernel(jars, JarHeuristic(jars), run);
+}
+
+#endif // JAR_KERNEL_HPP
@@ -1,17 +1,96 @@
 #ifndef MEDIDASBUSCA_HPP
 #define MEDIDASBUSCA_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 
+// Compilar com -DWATER_JUG_NO_STATS (make STATS=0) remove os contadores:
+// cada atualização fica atrás de uma constante falsa e o compilador a elimina.
+#ifdef WATER_JUG_NO_STATS
+#define WATER_JUG_STATS 0
+#else
+#define WATER_JUG_STATS 1
+#endif
+
+// Contadores preenchidos pelas buscas enquanto rodam (um incremento por
+// evento, sem varrer os nós no final). O objetivo, a profundidade e o custo
+// da solução são sempre registrados, mesmo sem estatísticas.
 class MedidasBusca
 {
 public:
-    int profundidadeMax = 0;
-    int nosVisitados = 0;
-    int nosExpandidos = 0;
-    int totalFilhosGerados = 0;
+    static const bool kAtivas = WATER_JUG_STATS != 0;
+
+    int profundidadeMax = 0;          // profundidade da solução
+    uint64_t nosVisitados = 0;        // estados distintos guardados
+    uint64_t nosExpandidos = 0;
+    uint64_t totalFilhosGerados = 0;  // filhos gerados, repetidos inclusive
+    uint64_t duplicados = 0;          // filhos descartados por já terem sido vistos
+    uint64_t retiradasObsoletas = 0;  // entradas velhas retiradas da fila de abertos
+    uint64_t reaberturas = 0;         // nós fechados reabertos por um caminho melhor
+    uint64_t consultasHash = 0;
+    uint64_t sondagensHash = 0;       // posições visitadas pelas consultas
+    uint64_t picoAbertos = 0;
+    uint64_t picoFechados = 0;
+    uint64_t iteracoes = 0;           // limiares do IDA*, camadas da busca externa
+    int indiceObjetivo = -1;          // nó objetivo na arena, -1 se não houver
     double tempoExecucao = 0.0;
     int custoCaminho = 0;
+    uint64_t bytesArena = 0;          // bytes tirados da arena da busca (sempre registrado)
+    uint64_t picoBytesArena = 0;      // maior volume vivo ao mesmo tempo
+
+    void reiniciar() { *this = MedidasBusca(); }
+
+    void expandiu() { if (kAtivas) ++nosExpandidos; }
+    void gerou(uint64_t n = 1) { if (kAtivas) totalFilhosGerados += n; }
+    void guardou(uint64_t n = 1) { if (kAtivas) nosVisitados += n; }
+    void duplicado() { if (kAtivas) ++duplicados; }
+    void retiradaObsoleta() { if (kAtivas) ++retiradasObsoletas; }
+    void reabriu() { if (kAtivas) ++reaberturas; }
+    void iteracao() { if (kAtivas) ++iteracoes; }
+    void abertos(size_t n) { if (kAtivas && n > picoAbertos) picoAbertos = n; }
+    void fechados(size_t n) { if (kAtivas && n > picoFechados) picoFechados = n; }
+    void sondagens(uint64_t consultas, uint64_t posicoes) {
+        if (!kAtivas) return;
+        consultasHash += consultas;
+        sondagensHash += posicoes;
+    }
+
+    // Soma os contadores de outra busca (trabalhadores paralelos); os picos
+    // também são somados, já que cada trabalhador tem suas próprias listas
+    void somar(const MedidasBusca& outra) {
+        if (!kAtivas) return;
+        nosVisitados += outra.nosVisitados;
+        nosExpandidos += outra.nosExpandidos;
+        totalFilhosGerados += outra.totalFilhosGerados;
+        duplicados += outra.duplicados;
+        retiradasObsoletas += outra.retiradasObsoletas;
+        reaberturas += outra.reaberturas;
+        consultasHash += outra.consultasHash;
+        sondagensHash += outra.sondagensHash;
+        picoAbertos += outra.picoAbertos;
+        picoFechados += outra.picoFechados;
+    }
+
+    double sondagemMedia() const {
+        return consultasHash ? static_cast<double>(sondagensHash) / consultasHash : 0.0;
+    }
+
+    void escreverJson(std::ostream& out) const
+    {
+        out << "{\"depth\":" << profundidadeMax << ",\"cost\":" << custoCaminho << ",\"goal\":" << indiceObjetivo
+            << ",\"time_ms\":" << tempoExecucao << ",\"arena_bytes\":" << bytesArena
+            << ",\"arena_peak_bytes\":" << picoBytesArena;
+        if (kAtivas) {
+            out << ",\"states\":" << nosVisitados << ",\"generated\":" << totalFilhosGerados
+                << ",\"expanded\":" << nosExpandidos << ",\"duplicates\":" << duplicados
+                << ",\"stale_pops\":" << retiradasObsoletas << ",\"reopenings\":" << reaberturas
+                << ",\"hash_lookups\":" << consultasHash << ",\"mean_probe_length\":" << sondagemMedia()
+                << ",\"peak_open\":" << picoAbertos << ",\"peak_closed\":" << picoFechados
+                << ",\"iterations\":" << iteracoes;
+        }
+        out << "}";
+    }
 
     void imprimirDados() const
     {
@@ -21,6 +100,7 @@ public:
         std::cout << "Custo da Solucao: " << custoCaminho << "\n";
         std::cout << "Nos visitados: " << nosVisitados << "\n";
         std::cout << "Nos expandidos: " << nosExpandidos << "\n";
+        std::cout << "Memoria da busca: " << bytesArena << " bytes (pico " << picoBytesArena << ")\n";
         std::cout << "Media de ramificacao: ";
         if (nosExpandidos > 0)
             std::cout << static_cast<double>(totalFilhosGerados) / nosExpandidos << "\n";
@@ -30,4 +110,4 @@ public:
     }
 };
 
-#endif // MEDIDASBUSCA_HPP
\ No newline at end of file
+#endif // MEDIDASBUSCA_HPP
@@ -0,0 +1,63 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+
+// Lock-free multi-producer single-consumer queue (Vyukov's intrusive design).
+// Producers push heap-allocated nodes, the single consumer pops and owns them.
+template <typename T>
+class MpscQueue {
+public:
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+        Node() : next(nullptr) {}
+    };
+
+    MpscQueue() : head(&stub), tail(&stub) {}
+
+    ~MpscQueue() {
+        while (Node* n = pop()) delete n;
+    }
+
+    // Any thread
+    void push(Node* n) {
+        n->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    // Consumer thread only. Returns nullptr when empty (or when a push is half done).
+    Node* pop() {
+        Node* t = tail;
+        Node* next = t->next.load(std::memory_order_acquire);
+        if (t == &stub) {
+            if (!next) return nullptr;
+            tail = next;
+            t = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail = next;
+            return t;
+        }
+        if (t != head.load(std::memory_order_acquire)) return nullptr;
+        push(&stub);
+        next = t->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return t;
+        }
+        return nullptr;
+    }
+
+private:
+    std::atomic<Node*> head;
+    Node* tail;
+    Node stub;
+
+    MpscQueue(const MpscQueue&);
+    MpscQueue& operator=(const MpscQueue&);
+};
+
+#endif // MPSC_QUEUE_HPP
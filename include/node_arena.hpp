@@ -0,0 +1,114 @@
+#ifndef NODE_ARENA_HPP
+#define NODE_ARENA_HPP
+
+#include "search_memory.hpp"
+#include "structure.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Search nodes stored as structure-of-arrays in fixed-size chunks.
+// Chunks never move once allocated, so node indices stay stable while the
+// arena grows. Jar values take 1 or 2 bytes each depending on the capacities.
+// Chunks come from the heap, or from a SearchMemory that owns them.
+class NodeArena {
+public:
+    enum Flags : uint8_t {
+        VISITED = 1,
+        CLOSED = 2
+    };
+
+    NodeArena();
+
+    // Takes chunks from `memory` from now on (nullptr: the heap). Its owner
+    // must clear() the arena whenever it releases the memory.
+    void use_memory(SearchMemory* memory);
+
+    // Prepares the arena for a new instance (drops all nodes, keeps heap chunks)
+    void reset(const std::vector<Jar>& jars);
+    // Drops all nodes; heap chunks are kept for the next search, chunks in a
+    // SearchMemory are forgotten along with it
+    void clear() {
+        count = 0;
+        if (memory) chunks.clear();
+    }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    int num_jars() const { return jars; }
+    int target() const { return target_Q; }
+    int value_width() const { return width; }
+    const std::vector<Jar>& initial_jars() const { return layout; }
+
+    int add(const GameState& state);
+    int add(const uint16_t* values, int parent, int g_cost, int f_cost);
+    void load_values(int i, uint16_t* out) const;
+    void store(int i, const GameState& state);   // overwrites node i with `state`
+    void load(int i, GameState& state) const;    // `state` must already have the instance's jars
+
+    int parent(int i) const { return chunk(i).parent[offset(i)]; }
+    int g_cost(int i) const { return chunk(i).g_cost[offset(i)]; }
+    int f_cost(int i) const { return chunk(i).f_cost[offset(i)]; }
+    bool visited(int i) const { return (chunk(i).flags[offset(i)] & VISITED) != 0; }
+    bool closed(int i) const { return (chunk(i).flags[offset(i)] & CLOSED) != 0; }
+
+    void set_parent(int i, int p) { chunk(i).parent[offset(i)] = p; }
+    void set_g_cost(int i, int g) { chunk(i).g_cost[offset(i)] = g; }
+    void set_f_cost(int i, int f) { chunk(i).f_cost[offset(i)] = f; }
+    void set_visited(int i, bool on = true) { set_flag(i, VISITED, on); }
+    void set_closed(int i, bool on = true) { set_flag(i, CLOSED, on); }
+
+    int value(int i, int jar) const {
+        const Chunk& c = chunk(i);
+        size_t pos = static_cast<size_t>(offset(i)) * jars + jar;
+        switch (width) {
+            case 1: return c.values[pos];
+            case 2: return reinterpret_cast<const uint16_t*>(c.values)[pos];
+            default: return reinterpret_cast<const int32_t*>(c.values)[pos];
+        }
+    }
+
+    bool same_values(int i, const std::vector<int>& values) const;
+    bool same_values(int i, const uint16_t* values) const;
+    bool is_goal(int i) const;
+    std::string to_key(int i) const;
+
+    size_t bytes_reserved() const { return chunks.size() * chunk_bytes; }
+
+private:
+    struct Chunk {
+        int32_t* parent;
+        int32_t* g_cost;
+        int32_t* f_cost;
+        uint8_t* flags;
+        unsigned char* values;
+    };
+
+    static const int kChunkShift = 12;
+    static const int kChunkSize = 1 << kChunkShift;
+
+    std::vector<std::unique_ptr<unsigned char[]>> blocks; // heap chunks
+    std::vector<Chunk> chunks;
+    SearchMemory* memory;
+    std::vector<Jar> layout;
+    size_t chunk_bytes;
+    int count;
+    int jars;
+    int width;
+    int target_Q;
+
+    const Chunk& chunk(int i) const { return chunks[i >> kChunkShift]; }
+    Chunk& chunk(int i) { return chunks[i >> kChunkShift]; }
+    static int offset(int i) { return i & (kChunkSize - 1); }
+
+    void set_flag(int i, uint8_t flag, bool on) {
+        uint8_t& f = chunk(i).flags[offset(i)];
+        f = on ? (f | flag) : (f & ~flag);
+    }
+    void set_value(int i, int jar, int v);
+    void grow();
+};
+
+#endif // NODE_ARENA_HPP
@@ -0,0 +1,55 @@
+#ifndef OPEN_LIST_HPP
+#define OPEN_LIST_HPP
+
+#include "bucket_queue.hpp"
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Comparator for priority_queue to prioritize states with lowest f_cost
+class CompareGameState {
+public:
+    bool operator()(const std::pair<int, int>& a, const std::pair<int, int>& b) const {
+        return a.second > b.second; // Min-heap: lower f_cost has higher priority
+    }
+};
+
+// Binary heap open list: a better path pushes a duplicate entry, stale ones are skipped on pop
+class HeapOpenList {
+public:
+    HeapOpenList(BucketQueue::TieBreak, SearchMemory* memory)
+        : heap(CompareGameState(), ArenaVector<std::pair<int, int> >(ArenaAllocator<std::pair<int, int> >(memory))) {}
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    void push(int idx, int f) { heap.push({idx, f}); }
+    void update(int idx, int f) { heap.push({idx, f}); }
+    int top_f() { return heap.top().second; }
+    std::pair<int, int> pop() {
+        std::pair<int, int> top = heap.top();
+        heap.pop();
+        return top;
+    }
+
+private:
+    std::priority_queue<std::pair<int, int>, ArenaVector<std::pair<int, int> >, CompareGameState> heap;
+};
+
+// Bucket queue open list: a better path moves the node to its new bucket in place
+class BucketOpenList {
+public:
+    BucketOpenList(BucketQueue::TieBreak tie, SearchMemory* memory) : queue(tie, memory) {}
+    bool empty() const { return queue.empty(); }
+    size_t size() const { return queue.size(); }
+    void push(int idx, int f) { queue.push(idx, f); }
+    void update(int idx, int f) { queue.update(idx, f); }
+    int top_f() { return queue.top_priority(); }
+    std::pair<int, int> pop() {
+        int f = queue.top_priority();
+        return {queue.pop(), f};
+    }
+
+private:
+    BucketQueue queue;
+};
+
+#endif // OPEN_LIST_HPP
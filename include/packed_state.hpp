@@ -0,0 +1,88 @@
+#ifndef PACKED_STATE_HPP
+#define PACKED_STATE_HPP
+
+#include "structure.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Jar values packed into a fixed-width key. Small instances only use `lo`,
+// bigger ones spill the remaining jars into `hi`.
+struct PackedState {
+    uint64_t lo;
+    uint64_t hi;
+
+    PackedState() : lo(0), hi(0) {}
+    PackedState(uint64_t l, uint64_t h) : lo(l), hi(h) {}
+
+    bool operator==(const PackedState& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const PackedState& other) const { return !(*this == other); }
+    bool operator<(const PackedState& other) const {
+        return hi < other.hi || (hi == other.hi && lo < other.lo);
+    }
+};
+
+struct PackedStateHash {
+    size_t operator()(const PackedState& s) const {
+        // splitmix64 finalizer over both words
+        uint64_t x = s.lo ^ (s.hi * 0x9E3779B97F4A7C15ULL);
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return static_cast<size_t>(x);
+    }
+};
+
+// Mixed-radix encoding of the jar values: jar i contributes
+// values[i] * stride[i] to its word, with radix (max_capacity + 1).
+class StateCodec {
+public:
+    StateCodec();
+    explicit StateCodec(const std::vector<Jar>& jars);
+
+    bool valid() const { return is_valid; }                 // false if the state does not fit in 128 bits
+    bool fits_single_word() const { return single_word; }
+    int num_jars() const { return static_cast<int>(stride.size()); }
+    uint64_t state_count() const { return total_states; } // saturates at UINT64_MAX
+    uint64_t jar_stride(int j) const { return stride[j]; }  // weight of jar j in its key word
+
+    // Perfect ranking: with a single-word key, key.lo is the mixed-radix index
+    // of the state, a dense number in [0, state_count())
+    bool rankable() const { return is_valid && single_word; }
+    template <typename T>
+    uint64_t rank(const T* values) const { return encode(values).lo; }
+    template <typename T>
+    void unrank(uint64_t r, T* values) const { decode(PackedState(r, 0), values); }
+
+    template <typename T>
+    PackedState encode(const T* values) const {
+        uint64_t w[2] = {0, 0};
+        for (size_t i = 0; i < stride.size(); ++i) {
+            w[word[i]] += static_cast<uint64_t>(values[i]) * stride[i];
+        }
+        return PackedState(w[0], w[1]);
+    }
+    PackedState encode(const std::vector<int>& values) const { return encode(values.data()); }
+    PackedState encode(const GameState& state) const { return encode(state.values); }
+    void decode(const PackedState& key, std::vector<int>& values) const;
+
+    template <typename T>
+    void decode(const PackedState& key, T* values) const {
+        const uint64_t w[2] = {key.lo, key.hi};
+        for (size_t i = 0; i < stride.size(); ++i) {
+            values[i] = static_cast<T>((w[word[i]] / stride[i]) % radix[i]);
+        }
+    }
+
+private:
+    std::vector<uint64_t> stride;
+    std::vector<uint64_t> radix;
+    std::vector<uint8_t> word;   // 0 = lo, 1 = hi
+    uint64_t total_states;
+    bool is_valid;
+    bool single_word;
+};
+
+#endif // PACKED_STATE_HPP
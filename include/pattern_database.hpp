@@ -0,0 +1,94 @@
+#ifndef PATTERN_DATABASE_HPP
+#define PATTERN_DATABASE_HPP
+
+#include "structure.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Pattern database over windows of adjacent jars. The row is cut into
+// consecutive windows; each window's abstract space keeps its own jars and
+// forgets the rest, so water poured across its edges may be any amount in
+// or out. A backward search from the window's goal stores the exact
+// abstract cost to the goal of every window state, in half units, in one
+// compact uint16_t array.
+//
+// ADDITIVE charges a pour across a window edge half to each side and sums
+// the windows; MAXIMUM charges it in full to both and takes the largest.
+// Either way the result is admissible and consistent.
+//
+// The file written by save() is a header, the capacities and the entries;
+// load() maps it read-only, like DistanceTable.
+class PatternDatabase {
+public:
+    enum Combine { ADDITIVE, MAXIMUM };
+
+    static const int kMaxWindow = 8;
+    static const uint16_t kUnreachable = 0xFFFF; // the window cannot reach its goal: neither can the state
+
+    ~PatternDatabase();
+
+    // nullptr if a single jar has more than `pattern_limit` values or the
+    // instance is not supported by the kernels
+    static std::unique_ptr<PatternDatabase> build(const std::vector<Jar>& jars, int window, Combine combine,
+                                                  uint64_t pattern_limit);
+    // Maps a database written by save(); nullptr if the file is missing,
+    // damaged or was built for other capacities or settings
+    static std::unique_ptr<PatternDatabase> load(const std::string& path, const std::vector<Jar>& jars, int window,
+                                                 Combine combine, uint64_t pattern_limit);
+    bool save(const std::string& path) const;
+
+    // Cache file name, e.g. "water_jug_pdb_w4_add_3_5_8.bin"
+    static std::string file_name(const std::vector<Jar>& jars, int window, Combine combine);
+
+    bool matches(const std::vector<Jar>& jars, int window, Combine combine, uint64_t pattern_limit) const;
+    size_t patterns() const { return layout.size(); }
+    uint64_t entries() const { return total_entries; }
+
+    // Lower bound on the cost to the goal
+    int estimate(const uint16_t* v) const {
+        int total = 0;
+        for (size_t p = 0; p < layout.size(); ++p) {
+            const Pattern& pattern = layout[p];
+            uint64_t r = 0;
+            for (int i = 0; i < pattern.count; ++i) r += v[pattern.first + i] * static_cast<uint64_t>(pattern.stride[i]);
+            int e = table[pattern.offset + r];
+            if (e == kUnreachable) return dead_end;
+            total = combine_as == ADDITIVE ? total + e : std::max(total, e);
+        }
+        return total / 2;
+    }
+
+private:
+    struct Pattern {
+        int first; // first jar of the window
+        int count;
+        uint64_t offset; // of its entries in the table
+        uint64_t size;
+        uint32_t stride[kMaxWindow];
+    };
+
+    std::vector<uint16_t> caps;
+    int window_size;
+    Combine combine_as;
+    uint64_t limit;
+    std::vector<Pattern> layout;
+    uint64_t total_entries;
+    int dead_end; // above every finite estimate, so dead ends keep the bound consistent
+    const uint16_t* table;
+    std::vector<uint16_t> own_table; // set by build()
+    void* mapping;                   // set by load()
+    size_t mapping_size;
+
+    PatternDatabase(const std::vector<Jar>& jars, int window, Combine combine, uint64_t pattern_limit);
+    bool plan();
+    void solve(const Pattern& pattern, uint16_t* out) const;
+    void find_dead_end();
+
+    PatternDatabase(const PatternDatabase&);
+    PatternDatabase& operator=(const PatternDatabase&);
+};
+
+#endif // PATTERN_DATABASE_HPP
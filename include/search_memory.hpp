@@ -0,0 +1,122 @@
+#ifndef SEARCH_MEMORY_HPP
+#define SEARCH_MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Monotonic arena for the memory of one search: node chunks, frontiers and
+// hash tables take their bytes from large blocks by bumping a cursor, and
+// giving memory back only updates the accounting. release() rewinds to the
+// first block in O(1) and keeps every block, so once a search of some size
+// has run, the next one of that size does not call malloc at all.
+// Not thread-safe: parallel engines only place their main-thread data here.
+class SearchMemory {
+public:
+    static const size_t kFirstBlock = 1 << 20;   // 1 MB
+    static const size_t kLargestBlock = 1 << 26; // growth stops doubling here
+    static const size_t kAlign = alignof(std::max_align_t);
+
+    SearchMemory() : current(0), cursor(0), handed_out(0), live(0), peak(0) {}
+
+    void* allocate(size_t bytes) {
+        bytes = (bytes + kAlign - 1) & ~(kAlign - 1);
+        if (current < blocks.size() && cursor + bytes <= blocks[current].size) {
+            void* p = blocks[current].data.get() + cursor;
+            cursor += bytes;
+            account(bytes);
+            return p;
+        }
+        return allocate_slow(bytes);
+    }
+
+    // The bytes are not reused before release(), they only stop counting as live
+    void deallocate(void*, size_t bytes) { live -= (bytes + kAlign - 1) & ~(kAlign - 1); }
+
+    // Counts memory the search owns outside the arena (e.g. a calloc'd bitset)
+    void track(size_t bytes) { account(bytes); }
+    void untrack(size_t bytes) { live -= bytes; }
+
+    // Forgets everything allocated since the last release; blocks are kept
+    void release() {
+        current = 0;
+        cursor = 0;
+        handed_out = 0;
+        live = 0;
+        peak = 0;
+    }
+
+    // Bytes handed out since the last release, freed ones included: the
+    // search's footprint, since a monotonic arena does not reuse them
+    uint64_t bytes_used() const { return handed_out; }
+    // Largest amount of memory the search held at once
+    uint64_t peak_bytes() const { return peak; }
+    uint64_t live_bytes() const { return live; }
+    uint64_t bytes_reserved() const;
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current; // block the cursor is in
+    size_t cursor;
+    uint64_t handed_out;
+    uint64_t live;
+    uint64_t peak;
+
+    void account(size_t bytes) {
+        handed_out += bytes;
+        live += bytes;
+        if (live > peak) peak = live;
+    }
+    void* allocate_slow(size_t bytes);
+
+    SearchMemory(const SearchMemory&);
+    SearchMemory& operator=(const SearchMemory&);
+};
+
+// Standard allocator over a SearchMemory; without one it uses the heap, so a
+// container type can serve both arena-backed and standalone instances.
+template <class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    explicit ArenaAllocator(SearchMemory* m = nullptr) : memory(m) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : memory(other.memory) {}
+
+    T* allocate(size_t n) {
+        if (!memory) return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(memory->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (memory) memory->deallocate(p, n * sizeof(T));
+        else ::operator delete(p);
+    }
+
+    SearchMemory* memory;
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.memory == b.memory; }
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.memory != b.memory; }
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+template <class T>
+using ArenaDeque = std::deque<T, ArenaAllocator<T> >;
+
+#endif // SEARCH_MEMORY_HPP
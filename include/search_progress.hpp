@@ -0,0 +1,95 @@
+#ifndef SEARCH_PROGRESS_HPP
+#define SEARCH_PROGRESS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Live view of a running search. The engine publishes into it with relaxed
+// atomic stores every kPublishEvery expansions, so the hot loop only pays
+// for a counter increment; a ProgressSampler reads it from another thread.
+class SearchProgress {
+public:
+    static const uint64_t kPublishEvery = 1024;
+
+    SearchProgress() { reset(); }
+
+    void reset() {
+        local = 0;
+        expansions.store(0, std::memory_order_relaxed);
+        frontier.store(0, std::memory_order_relaxed);
+        bound.store(-1, std::memory_order_relaxed);
+        best.store(-1, std::memory_order_relaxed);
+    }
+
+    // One expansion by a single-threaded engine, with its open list size
+    void expanded(size_t open) {
+        if (++local % kPublishEvery) return;
+        expansions.store(local, std::memory_order_relaxed);
+        frontier.store(open, std::memory_order_relaxed);
+    }
+    // Expansions done by one of several worker threads
+    void add_expansions(uint64_t n) { expansions.fetch_add(n, std::memory_order_relaxed); }
+    // Publishes the exact count of a single-threaded engine once it stops;
+    // workers add their unpublished remainder themselves
+    void finish() {
+        if (local) expansions.store(local, std::memory_order_relaxed);
+    }
+    void set_frontier(size_t open) { frontier.store(open, std::memory_order_relaxed); }
+    // Current f-layer, IDA* threshold or BFS depth
+    void set_bound(int b) { bound.store(b, std::memory_order_relaxed); }
+    void improve_best(int cost) {
+        int current = best.load(std::memory_order_relaxed);
+        while ((current == -1 || cost < current) && !best.compare_exchange_weak(current, cost)) {}
+    }
+
+    uint64_t expansions_so_far() const { return expansions.load(std::memory_order_relaxed); }
+    size_t frontier_size() const { return frontier.load(std::memory_order_relaxed); }
+    int current_bound() const { return bound.load(std::memory_order_relaxed); }
+    int best_cost() const { return best.load(std::memory_order_relaxed); }
+
+private:
+    uint64_t local; // owned by a single-threaded engine
+    std::atomic<uint64_t> expansions;
+    std::atomic<size_t> frontier;
+    std::atomic<int> bound;
+    std::atomic<int> best;
+
+    SearchProgress(const SearchProgress&);
+    SearchProgress& operator=(const SearchProgress&);
+};
+
+// Background thread that writes a snapshot of a SearchProgress every
+// `interval_ms` as one JSON line: elapsed time, expansions, nodes/sec over
+// the last interval, frontier size, bound, best goal cost and resident
+// memory. `path` may be a regular file or a FIFO; "-" writes to stderr.
+class ProgressSampler {
+public:
+    ProgressSampler(const SearchProgress& progress, const std::string& path, int interval_ms = 1000);
+    ~ProgressSampler(); // writes a last snapshot and joins the thread
+
+    bool ok() const { return out != nullptr; }
+
+private:
+    const SearchProgress& progress;
+    FILE* out;
+    bool owns_out;
+    int interval_ms;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::thread thread;
+
+    void loop();
+    void sample(double elapsed_ms, uint64_t& last_expansions, double& last_ms);
+
+    ProgressSampler(const ProgressSampler&);
+    ProgressSampler& operator=(const ProgressSampler&);
+};
+
+#endif // SEARCH_PROGRESS_HPP
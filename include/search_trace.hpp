@@ -0,0 +1,73 @@
+#ifndef SEARCH_TRACE_HPP
+#define SEARCH_TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Spans recorded by the searches, written in the Chrome trace event format
+// (chrome://tracing, Perfetto). Spans are kept in memory until write().
+class SearchTrace {
+public:
+    SearchTrace();
+
+    // Microseconds since the trace was created
+    uint64_t now_us() const;
+    // Complete event from `start_us` to now; `args` is the body of a JSON
+    // object such as "\"threshold\":12" (may be empty)
+    void span(const std::string& name, uint64_t start_us, const std::string& args);
+
+    size_t size() const;
+    bool write(const std::string& path) const;
+
+private:
+    struct Event {
+        std::string name;
+        std::string args;
+        uint64_t start_us;
+        uint64_t duration_us;
+        int tid;
+    };
+
+    std::chrono::steady_clock::time_point origin;
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::vector<std::thread::id> threads; // index = tid in the trace
+};
+
+// Back-to-back spans of one kind (IDA* iterations, BFS layers, A* f-layers):
+// next() closes the open span and starts the next one. Does nothing when the
+// trace is null.
+class TraceLayers {
+public:
+    TraceLayers(SearchTrace* t, const char* span_name, const char* arg_name)
+        : trace(t), name(span_name), arg(arg_name), open(false), value(0), start(0) {}
+    ~TraceLayers() { close(); }
+
+    void next(long v) {
+        if (!trace) return;
+        close();
+        open = true;
+        value = v;
+        start = trace->now_us();
+    }
+
+    void close() {
+        if (!trace || !open) return;
+        trace->span(name, start, "\"" + std::string(arg) + "\":" + std::to_string(value));
+        open = false;
+    }
+
+private:
+    SearchTrace* trace;
+    const char* name;
+    const char* arg;
+    bool open;
+    long value;
+    uint64_t start;
+};
+
+#endif // SEARCH_TRACE_HPP
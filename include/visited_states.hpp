@@ -0,0 +1,71 @@
+#ifndef VISITED_STATES_HPP
+#define VISITED_STATES_HPP
+
+#include "flat_state_table.hpp"
+#include "packed_state.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+// Set of states already seen by a search. When the instance's whole state
+// space has at most `dense_limit` states it is a bitset indexed by the
+// state's perfect rank, so a duplicate check is one bit test with no hashing
+// and no allocation; otherwise it falls back to a FlatStateTable.
+// The bitset stays on calloc, whose lazily zeroed pages a reused arena block
+// could not offer, but its size is counted in `memory` when one is given.
+class VisitedStates {
+public:
+    static const uint64_t kDefaultDenseLimit = 1ULL << 30; // states (128 MB of bits)
+
+    explicit VisitedStates(const StateCodec& codec, uint64_t dense_limit = kDefaultDenseLimit, SearchMemory* memory = nullptr)
+        : bits(nullptr, &std::free), bits_bytes(0), count(0), table(0, memory), memory(memory) {
+        if (codec.rankable() && codec.state_count() <= dense_limit) {
+            // calloc hands out zeroed pages lazily, untouched parts of a big space cost nothing
+            size_t words = static_cast<size_t>((codec.state_count() + 63) / 64);
+            bits.reset(static_cast<uint64_t*>(std::calloc(words, sizeof(uint64_t))));
+            if (bits) bits_bytes = words * sizeof(uint64_t);
+        }
+        if (!bits) table.reserve(table_estimate(codec));
+        if (memory) memory->track(bits_bytes);
+    }
+
+    ~VisitedStates() {
+        if (memory) memory->untrack(bits_bytes);
+    }
+
+    bool dense() const { return bits != nullptr; }
+
+    // Probe statistics of the hash fallback; the bitset needs no probing
+    void count_probes(bool on) { table.count_probes(on); }
+    uint64_t probe_lookups() const { return table.probe_lookups(); }
+    uint64_t probe_steps() const { return table.probe_steps(); }
+    size_t size() const { return dense() ? count : table.size(); }
+
+    bool contains(const PackedState& key) const {
+        if (dense()) return (bits.get()[key.lo >> 6] >> (key.lo & 63)) & 1;
+        return table.contains(key);
+    }
+
+    // Returns true if the state was not seen before
+    bool insert(const PackedState& key) {
+        if (!dense()) return table.insert(key);
+        uint64_t& word = bits.get()[key.lo >> 6];
+        uint64_t mask = 1ULL << (key.lo & 63);
+        if (word & mask) return false;
+        word |= mask;
+        ++count;
+        return true;
+    }
+
+private:
+    std::unique_ptr<uint64_t, void (*)(void*)> bits;
+    size_t bits_bytes;
+    size_t count;
+    FlatStateTable<char> table;
+    SearchMemory* memory;
+
+    VisitedStates(const VisitedStates&);
+    VisitedStates& operator=(const VisitedStates&);
+};
+
+#endif // VISITED_STATES_HPP
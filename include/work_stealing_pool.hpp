@@ -0,0 +1,55 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. A worker takes
+// its newest task first and, when its deque is empty, steals the oldest task
+// of another worker. Tasks receive the id of the worker running them, so
+// callers can keep per-worker scratch state indexed by it.
+class WorkStealingPool {
+public:
+    typedef std::function<void(int worker)> Task;
+
+    explicit WorkStealingPool(int threads);
+    ~WorkStealingPool();
+
+    int size() const { return static_cast<int>(queues.size()); }
+
+    // Queues a task, spreading tasks round-robin over the workers
+    void submit(const Task& task);
+    // Blocks until every submitted task has finished
+    void wait();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> threads;
+    std::mutex mutex;                  // guards the condition variables and `stopping`
+    std::condition_variable wake;      // tasks were queued
+    std::condition_variable idle;      // pending dropped to zero
+    std::atomic<long> queued;          // tasks sitting in deques
+    std::atomic<long> pending;         // tasks submitted and not finished
+    std::atomic<unsigned> next_queue;
+    bool stopping;
+
+    bool pop_local(int w, Task& task);
+    bool steal(int w, Task& task);
+    void worker_loop(int w);
+
+    WorkStealingPool(const WorkStealingPool&);
+    WorkStealingPool& operator=(const WorkStealingPool&);
+};
+
+#endif // WORK_STEALING_POOL_HPP
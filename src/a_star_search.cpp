@@ -1,154 +1,158 @@
 #include "structure.hpp"
 #include "executor.hpp"
-#include <queue>
-#include <unordered_map>
-
-// Comparator for priority_queue to prioritize states with lowest f_cost
-class CompareGameState {
-public:
-    bool operator()(const std::pair<int, int>& a, const std::pair<int, int>& b) const {
-        return a.second > b.second; // Min-heap: lower f_cost has higher priority
-    }
-};
-
-// Generates a child GameState from a parent state
-bool generate_child(GameState& current, std::vector<GameState>& states, int jar_idx, int action_type, GameState& child) {
-    if (jar_idx >= static_cast<int>(current.jars.size())) {
-        return false;
-    }
-
-    std::vector<Jar> new_jars = current.jars;
-    bool valid_action = false;
-
-    switch (action_type) {
-        case 0: // Empty
-            if (!new_jars[jar_idx].is_empty()) {
-                new_jars[jar_idx].empty();
-                valid_action = true;
-            }
-            break;
-        case 1: // Fill
-            if (!new_jars[jar_idx].is_full()) {
-                new_jars[jar_idx].fill();
-                valid_action = true;
-            }
-            break;
-        case 2: // Transfer Left
-            if (jar_idx > 0 && !new_jars[jar_idx].is_empty() && !new_jars[jar_idx - 1].is_full()) {
-                current.transfer_from_jars(new_jars[jar_idx], new_jars[jar_idx - 1]);
-                valid_action = true;
-            }
-            break;
-        case 3: // Transfer Right
-            if (jar_idx < static_cast<int>(new_jars.size()) - 1 && !new_jars[jar_idx].is_empty() && !new_jars[jar_idx + 1].is_full()) {
-                current.transfer_from_jars(new_jars[jar_idx], new_jars[jar_idx + 1]);
-                valid_action = true;
-            }
-            break;
-        default:
-            return false;
-    }
-
-    if (valid_action) {
-        child = GameState(new_jars, current.index);
-        return true;
-    }
-    return false;
-}
-
-// A* implementation with corrected behavior
-void SearchAlgorithms::solve_with_astar(const std::vector<Jar>& initial_jars) {
-    if (initial_jars.empty()) return;
-
-    states.clear();
-    states.emplace_back(initial_jars, -1);
-    states[0].index = 0;
-    states[0].g_cost = 0;
-    states[0].f_cost = states[0].heuristic();
-    states[0].visited = false;
+#include "packed_state.hpp"
+#include "flat_state_table.hpp"
+#include "jar_kernel.hpp"
+#include "open_list.hpp"
+#include "search_trace.hpp"
+
+// A* over a jar kernel (specialized for the jar count when possible).
+// Returns the goal node index, or -1.
+template <class OpenList, class Kernel>
+int astar_search(const Kernel& kernel, NodeArena& nodes, MedidasBusca& stats, SearchProgress& progress, SearchTrace* trace,
+                 const StateCodec& codec, BucketQueue::TieBreak tie, SearchMemory& memory) {
+    typename Kernel::State current = kernel.initial_state(); // values of the node being expanded
+    typename Kernel::State scratch = kernel.make_state();
+
+    nodes.add(current.data(), -1, 0, kernel.heuristic(current.data()));
+
+    const bool reopen = !kernel.heuristic_consistent(); // closed nodes may still get a cheaper path
+    OpenList open_list(tie, &memory);
+    FlatStateTable<int> visited_map(table_estimate(codec), &memory);
+    visited_map.count_probes(MedidasBusca::kAtivas);
+
+    open_list.push(0, nodes.f_cost(0));
+    visited_map.insert(codec.encode(current.data()), 0);
+    stats.guardou();
 
-    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, CompareGameState> open_list;
-    std::unordered_map<std::string, int> visited_map;
-
-    open_list.push({0, states[0].f_cost});
-    visited_map[states[0].to_key()] = 0;
-
-    int total_states = 1;
     bool goal_found = false;
     int goal_found_f_cost = INT_MAX;
-    int goal_found_idx = -1;
+    int goal_idx = -1;
+    int f_layer = -1; // highest f popped so far, a new value opens a trace span
+    TraceLayers layers(trace, "astar f-layer", "f");
 
     while (!open_list.empty()) {
-        auto top = open_list.top();
+        stats.abertos(open_list.size());
+        progress.expanded(open_list.size());
+        std::pair<int, int> top = open_list.pop();
         int current_idx = top.first;
         int popped_f = top.second;
-        open_list.pop();
-
-        GameState& current = states[current_idx];
 
         // Skip stale or already visited states
-        if (popped_f > current.f_cost || current.visited) continue;
+        if (popped_f > nodes.f_cost(current_idx) || nodes.visited(current_idx)) {
+            stats.retiradaObsoleta();
+            continue;
+        }
 
         // Optimization: prune worse paths after goal is found
-        if (goal_found && current.f_cost >= goal_found_f_cost) break;
+        if (goal_found && nodes.f_cost(current_idx) >= goal_found_f_cost) break;
 
-        current.visited = true;
+        if (popped_f > f_layer) {
+            f_layer = popped_f;
+            layers.next(f_layer);
+            progress.set_bound(f_layer);
+        }
 
-        if (current.is_goal()) {
-            if (!goal_found || current.f_cost < goal_found_f_cost) {
+        nodes.set_visited(current_idx);
+        nodes.load_values(current_idx, current.data());
+        int current_g = nodes.g_cost(current_idx);
+        JarHeuristicTerms terms = kernel.heuristic_terms(current.data());
+
+        if (kernel.is_goal(current.data())) {
+            if (!goal_found || nodes.f_cost(current_idx) < goal_found_f_cost) {
                 goal_found = true;
-                goal_found_f_cost = current.f_cost;
-                goal_found_idx = current.index;
+                goal_found_f_cost = nodes.f_cost(current_idx);
+                goal_idx = current_idx;
+                progress.improve_best(nodes.g_cost(current_idx));
                 // Don't return yet: continue expanding better nodes
             }
         }
 
         // Expand all valid children
-        for (int jar_idx = 0; jar_idx < static_cast<int>(current.jars.size()); ++jar_idx) {
-            for (int action_type = 0; action_type < 4; ++action_type) {
-                if (action_type == 2 && jar_idx == 0) continue;
-                if (action_type == 3 && jar_idx == static_cast<int>(current.jars.size()) - 1) continue;
-
-                GameState child;
-                if (generate_child(current, states, jar_idx, action_type, child)) {
-                    std::string child_key = child.to_key();
-
-                    int action_cost = current.calculate_action_cost(jar_idx, action_type);
-                    int tentative_g = current.g_cost + action_cost;
-                    int child_h = child.heuristic();
-                    int child_f = tentative_g + child_h;
-
-                    // Skip children that would not improve the result
-                    if (goal_found && child_f >= goal_found_f_cost) continue;
-
-                    auto it = visited_map.find(child_key);
-                    if (it != visited_map.end()) {
-                        int existing_idx = it->second;
-                        if (states[existing_idx].visited || tentative_g >= states[existing_idx].g_cost) {
-                            continue; // Not better
-                        }
-                        // Better path found, update
-                        states[existing_idx].g_cost = tentative_g;
-                        states[existing_idx].f_cost = child_f;
-                        states[existing_idx].parent = current.index;
-                        open_list.push({existing_idx, child_f});
-                    } else {
-                        // New child state
-                        child.g_cost = tentative_g;
-                        child.f_cost = child_f;
-                        child.index = states.size();
-                        child.visited = false;
-                        states.push_back(child);
-                        visited_map[child_key] = child.index;
-                        open_list.push({child.index, child_f});
-                        total_states++;
-                    }
+        stats.expandiu();
+        kernel.for_each_successor(current.data(), scratch.data(), [&](const uint16_t* child, int action_cost, int jar, int type) {
+            stats.gerou();
+            int tentative_g = current_g + action_cost;
+            int child_f = tentative_g + kernel.child_heuristic(terms, current.data(), child, jar, type);
+
+            // Skip children that would not improve the result
+            if (goal_found && child_f >= goal_found_f_cost) return;
+
+            PackedState child_key = codec.encode(child);
+            int* existing = visited_map.find(child_key);
+            if (existing) {
+                int existing_idx = *existing;
+                bool closed = nodes.visited(existing_idx);
+                if ((closed && !reopen) || tentative_g >= nodes.g_cost(existing_idx)) {
+                    stats.duplicado();
+                    return; // Not better
+                }
+                // Better path found, update
+                nodes.set_g_cost(existing_idx, tentative_g);
+                nodes.set_f_cost(existing_idx, child_f);
+                nodes.set_parent(existing_idx, current_idx);
+                if (closed) {
+                    nodes.set_visited(existing_idx, false);
+                    nodes.set_closed(existing_idx, false);
+                    open_list.push(existing_idx, child_f);
+                    stats.reabriu();
+                } else {
+                    open_list.update(existing_idx, child_f);
                 }
+            } else {
+                // New child state
+                int child_idx = nodes.add(child, current_idx, tentative_g, child_f);
+                visited_map.insert(child_key, child_idx);
+                open_list.push(child_idx, child_f);
+                stats.guardou();
             }
+        });
+
+        nodes.set_closed(current_idx);
+    }
+    stats.fechados(stats.nosExpandidos);
+    stats.sondagens(visited_map.probe_lookups(), visited_map.probe_steps());
+    return goal_idx;
+}
+
+struct AStarRunner {
+    NodeArena& nodes;
+    MedidasBusca& stats;
+    SearchProgress& progress;
+    SearchTrace* trace;
+    const StateCodec& codec;
+    SearchAlgorithms::OpenListKind open_list;
+    BucketQueue::TieBreak tie;
+    SearchMemory& memory;
+    int goal;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        if (open_list == SearchAlgorithms::BUCKET_QUEUE) {
+            goal = astar_search<BucketOpenList>(kernel, nodes, stats, progress, trace, codec, tie, memory);
+        } else {
+            goal = astar_search<HeapOpenList>(kernel, nodes, stats, progress, trace, codec, tie, memory);
         }
+    }
+};
 
-        current.closed = true;
+void SearchAlgorithms::solve_with_astar(const std::vector<Jar>& initial_jars) {
+    begin_search();
+    if (initial_jars.empty()) return;
+
+    if (astar_threads > 1) {
+        solve_with_hda_star(initial_jars, astar_threads);
+        return;
     }
 
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instance not supported by the search kernels.\n";
+        return;
+    }
 
+    nodes.reset(initial_jars);
+    AStarRunner runner = {nodes, medidas, progress, trace, codec, astar_open_list, astar_tie_break, memory, -1};
+    with_jar_kernel(initial_jars, search_heuristic(initial_jars), runner);
+    record_goal(runner.goal);
 }
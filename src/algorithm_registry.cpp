@@ -0,0 +1,40 @@
+#include "algorithm_registry.hpp"
+
+namespace {
+
+void run_backtracking(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.solve_with_backtracking(jars); }
+void run_dfs(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.busca_profundidade(jars, 10); }
+void run_bfs(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.busca_largura(jars); }
+void run_ucs(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.busca_ordenada(jars); }
+void run_greedy(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.busca_gulosa(jars); }
+void run_astar(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.solve_with_astar(jars); }
+void run_ara(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.solve_with_ara_star(jars); }
+void run_sma(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.solve_with_sma_star(jars); }
+void run_ida(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.solve_with_ida_star(jars); }
+void run_table(SearchAlgorithms& s, const std::vector<Jar>& jars) { s.solve_with_distance_table(jars); }
+
+} // namespace
+
+const std::vector<SearchAlgorithmEntry>& search_algorithms() {
+    static const std::vector<SearchAlgorithmEntry> entries = {
+        {"backtracking", run_backtracking},
+        {"dfs", run_dfs},
+        {"bfs", run_bfs},
+        {"ucs", run_ucs},
+        {"greedy", run_greedy},
+        {"astar", run_astar},
+        {"ara", run_ara},
+        {"sma", run_sma},
+        {"ida", run_ida},
+        {"table", run_table},
+    };
+    return entries;
+}
+
+const SearchAlgorithmEntry* find_search_algorithm(const std::string& name) {
+    const std::vector<SearchAlgorithmEntry>& entries = search_algorithms();
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (name == entries[i].name) return &entries[i];
+    }
+    return nullptr;
+}
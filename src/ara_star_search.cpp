@@ -0,0 +1,277 @@
+#include "executor.hpp"
+#include "flat_state_table.hpp"
+#include "jar_kernel.hpp"
+#include "search_trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <iostream>
+
+// Anytime Repairing A* (ARA*). Each pass is a weighted A* on f = g + w*h that
+// stops as soon as the goal's g is no larger than the best key in OPEN. The
+// next pass lowers w and repairs the same search instead of starting over:
+// nodes whose g improved after they were closed wait in INCONS and rejoin
+// OPEN, and every key is recomputed for the new weight. A solution is
+// published whenever it gets cheaper or its bound tighter; the bound is
+// min(w, cost / smallest g + h in OPEN and INCONS), 1 meaning optimal.
+template <class Kernel>
+class AraStar {
+public:
+    struct Params {
+        double initial_weight;
+        double weight_step;
+        double time_budget_ms; // 0: no limit
+        uint64_t node_budget;  // expansions, 0: no limit
+    };
+
+    AraStar(const Kernel& k, NodeArena& n, MedidasBusca& s, SearchProgress& p, SearchTrace* t, const StateCodec& c,
+            SearchMemory& memory, const Params& options)
+        : kernel(k), nodes(n), stats(s), progress(p), trace(t), codec(c), params(options),
+          table(table_estimate(c), &memory), where(ArenaAllocator<uint8_t>(&memory)), open(ArenaAllocator<Entry>(&memory)),
+          incons(ArenaAllocator<int>(&memory)), closed_list(ArenaAllocator<int>(&memory)),
+          goal(-1), expansions(0), out_of_budget(false) {
+        table.count_probes(MedidasBusca::kAtivas);
+    }
+
+    // Returns the goal node of the best solution, or -1
+    int run(std::vector<AnytimeSolution>& solutions) {
+        start = std::chrono::steady_clock::now();
+        typename Kernel::State initial = kernel.initial_state();
+        int h = kernel.heuristic(initial.data());
+        add_node(initial.data(), -1, 0, h, codec.encode(initial.data()));
+
+        double w = std::max(1.0, params.initial_weight);
+        double last_bound = 0;
+        TraceLayers passes(trace, "ara pass", "weight_pct");
+        push(0, w);
+        while (true) {
+            stats.iteracao();
+            passes.next(std::lround(w * 100));
+            bool complete = improve_path(w);
+            if (goal != -1) {
+                double bound = solution_bound(complete ? w : last_bound);
+                if (solutions.empty() || nodes.g_cost(goal) < solutions.back().cost || bound < last_bound) {
+                    publish(solutions, w, bound);
+                }
+                last_bound = bound;
+                if (bound <= 1.0) break;
+            }
+            if (!complete || w <= 1.0 || goal == -1) break; // without a goal the pass saw every reachable state
+
+            w = std::max(1.0, w - params.weight_step);
+            next_pass(w);
+        }
+        stats.fechados(closed_list.size());
+        stats.sondagens(table.probe_lookups(), table.probe_steps());
+        return goal;
+    }
+
+private:
+    enum Where : uint8_t { NEW, OPEN, CLOSED, INCONS };
+
+    struct Entry {
+        double key;
+        int g; // g when pushed: a node whose g changed since is stale
+        int idx;
+    };
+    struct EntryAfter {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.key != b.key) return a.key > b.key;
+            return a.g < b.g; // on ties, deeper nodes first
+        }
+    };
+
+    const Kernel& kernel;
+    NodeArena& nodes;
+    MedidasBusca& stats;
+    SearchProgress& progress;
+    SearchTrace* trace;
+    const StateCodec& codec;
+    Params params;
+    FlatStateTable<int> table;
+    ArenaVector<uint8_t> where;  // per node
+    ArenaVector<Entry> open;     // binary heap
+    ArenaVector<int> incons;     // closed nodes whose g improved this pass
+    ArenaVector<int> closed_list;
+    int goal;
+    uint64_t expansions;
+    bool out_of_budget;
+    std::chrono::steady_clock::time_point start;
+
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    int h_of(int idx) const { return nodes.f_cost(idx) - nodes.g_cost(idx); }
+
+    void add_node(const uint16_t* values, int parent, int g, int h, const PackedState& key) {
+        int idx = nodes.add(values, parent, g, g + h);
+        table.insert(key, idx);
+        where.push_back(NEW);
+        stats.guardou();
+        if (kernel.is_goal(values)) goal = idx;
+    }
+
+    void push(int idx, double w) {
+        where[idx] = OPEN;
+        Entry e = {nodes.g_cost(idx) + w * h_of(idx), nodes.g_cost(idx), idx};
+        open.push_back(e);
+        std::push_heap(open.begin(), open.end(), EntryAfter());
+    }
+
+    bool stale(const Entry& e) const { return where[e.idx] != OPEN || e.g != nodes.g_cost(e.idx); }
+
+    bool budget_left() {
+        if (params.node_budget && expansions >= params.node_budget) out_of_budget = true;
+        if (params.time_budget_ms > 0 && (expansions & 255) == 0 && elapsed_ms() >= params.time_budget_ms) out_of_budget = true;
+        return !out_of_budget;
+    }
+
+    // One weighted A* pass; false if the budget ran out first
+    bool improve_path(double w) {
+        typename Kernel::State current = kernel.make_state();
+        typename Kernel::State scratch = kernel.make_state();
+        while (!open.empty()) {
+            const Entry& top = open.front();
+            if (stale(top)) {
+                std::pop_heap(open.begin(), open.end(), EntryAfter());
+                open.pop_back();
+                stats.retiradaObsoleta();
+                continue;
+            }
+            if (goal != -1 && nodes.g_cost(goal) <= top.key) return true;
+            if (!budget_left()) return false;
+
+            int idx = top.idx;
+            std::pop_heap(open.begin(), open.end(), EntryAfter());
+            open.pop_back();
+            where[idx] = CLOSED;
+            closed_list.push_back(idx);
+            nodes.set_visited(idx);
+            nodes.set_closed(idx);
+            nodes.load_values(idx, current.data());
+
+            ++expansions;
+            stats.expandiu();
+            stats.abertos(open.size());
+            progress.expanded(open.size());
+            int g = nodes.g_cost(idx);
+            JarHeuristicTerms terms = kernel.heuristic_terms(current.data());
+            kernel.for_each_successor(current.data(), scratch.data(), [&](const uint16_t* child, int cost, int jar, int type) {
+                stats.gerou();
+                int child_g = g + cost;
+                PackedState key = codec.encode(child);
+                int* existing = table.find(key);
+                if (!existing) {
+                    add_node(child, idx, child_g, kernel.child_heuristic(terms, current.data(), child, jar, type), key);
+                    push(nodes.size() - 1, w);
+                    return;
+                }
+                int other = *existing;
+                if (child_g >= nodes.g_cost(other)) {
+                    stats.duplicado();
+                    return;
+                }
+                int h = h_of(other);
+                nodes.set_g_cost(other, child_g);
+                nodes.set_f_cost(other, child_g + h);
+                nodes.set_parent(other, idx);
+                if (where[other] == CLOSED) {
+                    where[other] = INCONS; // repaired by the next pass
+                    incons.push_back(other);
+                    stats.reabriu();
+                } else if (where[other] != INCONS) {
+                    push(other, w);
+                }
+            });
+        }
+        return true;
+    }
+
+    // Bound on cost / optimal cost: every cheaper path goes through a node of
+    // OPEN or INCONS, whose g + h is a lower bound on it
+    double solution_bound(double pass_bound) const {
+        int min_f = INT_MAX;
+        for (size_t i = 0; i < open.size(); ++i) {
+            if (!stale(open[i])) min_f = std::min(min_f, nodes.f_cost(open[i].idx));
+        }
+        for (size_t i = 0; i < incons.size(); ++i) min_f = std::min(min_f, nodes.f_cost(incons[i]));
+
+        int cost = nodes.g_cost(goal);
+        double bound = min_f >= cost ? 1.0 : static_cast<double>(cost) / std::max(min_f, 1);
+        return pass_bound > 0 ? std::min(bound, pass_bound) : bound;
+    }
+
+    // OPEN := OPEN + INCONS with keys for the new weight, CLOSED := empty
+    void next_pass(double w) {
+        for (size_t i = 0; i < closed_list.size(); ++i) {
+            if (where[closed_list[i]] == CLOSED) where[closed_list[i]] = NEW;
+        }
+        closed_list.clear();
+
+        ArenaVector<Entry> entries(open.get_allocator());
+        entries.swap(open);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (stale(entries[i])) continue;
+            where[entries[i].idx] = NEW; // one entry per node
+            push(entries[i].idx, w);
+        }
+        for (size_t i = 0; i < incons.size(); ++i) push(incons[i], w);
+        incons.clear();
+    }
+
+    void publish(std::vector<AnytimeSolution>& solutions, double w, double bound) {
+        AnytimeSolution s = {nodes.g_cost(goal), bound, w, elapsed_ms(), expansions};
+        solutions.push_back(s);
+        progress.improve_best(s.cost);
+    }
+};
+
+struct AraStarRunner {
+    NodeArena& nodes;
+    MedidasBusca& stats;
+    SearchProgress& progress;
+    SearchTrace* trace;
+    const StateCodec& codec;
+    SearchMemory& memory;
+    double initial_weight;
+    double weight_step;
+    double time_budget_ms;
+    uint64_t node_budget;
+    std::vector<AnytimeSolution>& solutions;
+    int goal;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        typename AraStar<Kernel>::Params params = {initial_weight, weight_step, time_budget_ms, node_budget};
+        AraStar<Kernel> search(kernel, nodes, stats, progress, trace, codec, memory, params);
+        goal = search.run(solutions);
+    }
+};
+
+void SearchAlgorithms::solve_with_ara_star(const std::vector<Jar>& initial_jars) {
+    begin_search();
+    anytime_solutions.clear();
+    if (initial_jars.empty()) return;
+
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instance not supported by the search kernels.\n";
+        return;
+    }
+
+    nodes.reset(initial_jars);
+    AraStarRunner runner = {nodes, medidas, progress, trace, codec, memory, ara_initial_weight,
+                            std::max(ara_weight_step, 0.01), ara_time_budget_ms, ara_node_budget, anytime_solutions, -1};
+    with_jar_kernel(initial_jars, search_heuristic(initial_jars), runner);
+    record_goal(runner.goal);
+
+    if (!verbose) return;
+    for (size_t i = 0; i < anytime_solutions.size(); ++i) {
+        const AnytimeSolution& s = anytime_solutions[i];
+        std::cout << "w=" << s.weight << ": cost " << s.cost << ", at most " << s.bound << "x optimal (" << s.time_ms
+                  << " ms, " << s.expansions << " expansions)\n";
+    }
+    if (runner.goal == -1) std::cout << "No solution found.\n";
+}
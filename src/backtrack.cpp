@@ -1,163 +1,121 @@
 #include "structure.hpp"
 #include "executor.hpp"
+#include "jar_kernel.hpp"
 #include <iostream>
 #include <vector>
 #include <algorithm>
 
-bool checkParentLoopBck(const GameState& child, int current_index, const std::vector<GameState>& states) {
-    if (current_index < 0 || current_index >= static_cast<int>(states.size())) {
-        return false;
-    }
-    if (child.parent == -1) {
-        return false;
-    }
-    if (child.parent < 0 || child.parent >= static_cast<int>(states.size())) {
-        return false;
-    }
-
-    int ancestor_idx = child.parent;
-    std::string child_key = child.to_key();
+bool checkParentLoopBck(const uint16_t* child, int parent_index, const NodeArena& nodes) {
+    int ancestor_idx = parent_index;
     while (ancestor_idx != -1) {
-        if (states[ancestor_idx].to_key() == child_key) {
+        if (nodes.same_values(ancestor_idx, child)) {
             return true;
         }
-        ancestor_idx = states[ancestor_idx].parent;
+        ancestor_idx = nodes.parent(ancestor_idx);
     }
     return false;
 }
 
-bool generate_one_child(int current_index, std::vector<GameState>& states, int& action_index, GameState& child, int jar_idx) {
-    if (current_index < 0 || current_index >= static_cast<int>(states.size())) {
-        return false;
-    }
-
-    std::vector<Jar> jars = states[current_index].jars;
-    int num_jars = jars.size();
-    int action_type = action_index;
-
-    if (action_type > 3 || (action_type == 3 && jar_idx == num_jars - 1)) {
-        return false;
-    }
-
-    if (jar_idx >= num_jars) {
-        return false;
-    }
-
-    if (jars[jar_idx].max_capacity <= 0 || jars[jar_idx].current_value < 0 || jars[jar_idx].current_value > jars[jar_idx].max_capacity) {
-        return false;
-    }
+// Depth-first backtracking that stores every generated node. Each frame holds
+// the children of its node, expanded once into a buffer reused at that depth.
+template <class Kernel>
+struct Backtracking {
+    struct Frame {
+        int node;
+        int next; // next child of `buffer` to try
+        SuccessorBuffer buffer;
+    };
+
+    const Kernel& kernel;
+    NodeArena& nodes;
+    MedidasBusca& stats;
+    SearchProgress& progress;
+    ArenaVector<Frame> frames;
+
+    // Returns the goal node index, or -1
+    int run() {
+        typename Kernel::State initial = kernel.initial_state();
+        typename Kernel::State current = kernel.make_state();
+        nodes.add(initial.data(), -1, 0, 0);
+        stats.guardou();
+
+        int depth = 0;
+        if (!enter(0, 0, initial.data())) return 0;
+
+        while (depth >= 0) {
+            Frame& frame = frames[depth];
+            if (frame.next == frame.buffer.count) {
+                nodes.set_closed(frame.node);
+                --depth; // backtrack
+                continue;
+            }
 
-    std::vector<Jar> new_jars = jars;
-    bool valid_action = false;
-    std::string action_name;
+            int k = frame.next++;
+            const uint16_t* child = frame.buffer.child(k);
+            if (checkParentLoopBck(child, frame.node, nodes)) {
+                stats.duplicado();
+                continue;
+            }
 
-    switch (action_type) {
-        case 0: // Empty
-            action_name = "Esvaziar";
-            if (!jars[jar_idx].is_empty()) {
-                new_jars[jar_idx].empty();
-                valid_action = true;
-            } 
-            break;
-        case 1: // Fill
-            action_name = "Encher";
-            if (!jars[jar_idx].is_full()) {
-                new_jars[jar_idx].fill();
-                valid_action = true;
-            } 
-            break;
-        case 2: // Transfer Left
-            action_name = "Transferir Esquerda";
-            if (jar_idx > 0 && !jars[jar_idx].is_empty() && !jars[jar_idx - 1].is_full()) {
-                int amount = new_jars[jar_idx].current_value;
-                int difference = new_jars[jar_idx - 1].transfer(amount);
-                new_jars[jar_idx].current_value = difference;
-                valid_action = true;
-            } 
-            break;
-        case 3: // Transfer Right
-            action_name = "Transferir Direita";
-            if (jar_idx < num_jars - 1 && !jars[jar_idx].is_empty() && !jars[jar_idx + 1].is_full()) {
-                int amount = new_jars[jar_idx].current_value;
-                int difference = new_jars[jar_idx + 1].transfer(amount);
-                new_jars[jar_idx].current_value = difference;
-                valid_action = true;
-            } 
-            break;
+            int g = nodes.g_cost(frame.node) + frame.buffer.costs[k];
+            int idx = nodes.add(child, frame.node, g, g);
+            stats.guardou();
+            for (int j = 0; j < kernel.num_jars(); ++j) current[j] = child[j];
+            ++depth;
+            if (!enter(depth, idx, current.data())) return idx;
+        }
+        return -1;
     }
 
-    if (valid_action) {
-        for (size_t i = 0; i < new_jars.size(); ++i) {
-            if (new_jars[i].current_value < 0 || new_jars[i].current_value > new_jars[i].max_capacity) {
-                return false;
-            }
-        }
-        child = GameState(new_jars, current_index);
-        if (checkParentLoopBck(child, current_index, states)) {
-            return false;
-        }
-        // Calculate g_cost for the child
-        int action_cost = states[current_index].calculate_action_cost(jar_idx, action_type);
-        child.g_cost = states[current_index].g_cost + action_cost;
+    // Makes node `idx` the frame at `depth`; false if it is a goal
+    bool enter(int depth, int idx, const uint16_t* values) {
+        if (kernel.is_goal(values)) return false;
+        nodes.set_visited(idx);
+        if (static_cast<int>(frames.size()) <= depth) frames.resize(depth + 1);
+        Frame& frame = frames[depth];
+        frame.node = idx;
+        frame.next = 0;
+        stats.expandiu();
+        stats.gerou(expand_successors(kernel, values, frame.buffer));
+        stats.abertos(depth + 1);
+        progress.expanded(depth + 1);
         return true;
     }
-
-    return false;
-}
+};
+
+struct BacktrackingRunner {
+    NodeArena& nodes;
+    MedidasBusca& stats;
+    SearchProgress& progress;
+    SearchMemory& memory;
+    int goal;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        typedef typename Backtracking<Kernel>::Frame Frame;
+        Backtracking<Kernel> search = {kernel, nodes, stats, progress, ArenaVector<Frame>(ArenaAllocator<Frame>(&memory))};
+        goal = search.run();
+    }
+};
 
 GameState SearchAlgorithms::solve_with_backtracking(const std::vector<Jar>& initial_jars) {
-    if (initial_jars.empty()) {
+    begin_search();
+    if (initial_jars.empty() || !kernel_supports(initial_jars)) {
         return GameState(); // invalid input
     }
 
-    states.clear();
-    states.emplace_back(initial_jars, -1);
-    states[0].g_cost = 0;
-
-    std::vector<int> action_indices(1, 0); // track which action we're on
-    std::vector<int> jar_indices(1, 0);    // track which jar we're on
-
-    int current_index = 0;
-    size_t total_states = 1;
-
-    while (current_index >= 0) {
-        if (states[current_index].is_goal()) {
-            std::cout << "🎯 Goal found! Explored: " << total_states << " states.\n";
-            return states[current_index];
-        }
-
-        states[current_index].visited = true;
-
-        int action = action_indices[current_index];
-        int jar = jar_indices[current_index];
-
-        if (action > 3) {
-            action_indices[current_index] = 0;
-            jar_indices[current_index]++;
-            jar = jar_indices[current_index];
-        }
-
-        if (jar >= static_cast<int>(initial_jars.size())) {
-            states[current_index].closed = true;
-            current_index = states[current_index].parent; // backtrack
-            continue;
-        }
+    nodes.reset(initial_jars);
+    BacktrackingRunner runner = {nodes, medidas, progress, memory, -1};
+    with_jar_kernel(initial_jars, runner);
+    record_goal(runner.goal);
 
-        GameState child;
-        if (generate_one_child(current_index, states, action_indices[current_index], child, jar_indices[current_index])) {
-            // Found valid child, push it and move to it
-            states.push_back(child);
-            action_indices[current_index]++; // move to next action on this node
-            action_indices.push_back(0);     // new child starts at 0 action
-            jar_indices.push_back(0);        // new child starts at jar 0
-            current_index = static_cast<int>(states.size() - 1);
-            total_states++;
-        } else {
-            // Invalid move, try next action
-            action_indices[current_index]++;
-        }
+    if (runner.goal == -1) {
+        if (verbose) std::cout << "❌ No solution found. Explored: " << nodes.size() << " states.\n";
+        return GameState(); // no solution
     }
 
-    std::cout << "❌ No solution found. Explored: " << total_states << " states.\n";
-    return GameState(); // no solution
+    if (verbose) std::cout << "🎯 Goal found! Explored: " << nodes.size() << " states.\n";
+    GameState goal(initial_jars, -1);
+    nodes.load(runner.goal, goal);
+    return goal;
 }
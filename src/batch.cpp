@@ -0,0 +1,149 @@
+#include "batch.hpp"
+#include "algorithm_registry.hpp"
+#include "executor.hpp"
+#include "work_stealing_pool.hpp"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+bool parse_batch_line(const std::string& text, const std::string& default_algorithm, BatchInstance& out, std::string& error) {
+    std::istringstream tokens(text);
+    std::string token;
+    out.algorithm = default_algorithm;
+    out.jars.clear();
+
+    bool first = true;
+    while (tokens >> token) {
+        bool leading = first;
+        first = false;
+        if (leading && !std::isdigit(static_cast<unsigned char>(token[0]))) {
+            if (!find_search_algorithm(token)) {
+                error = "unknown algorithm '" + token + "'";
+                return false;
+            }
+            out.algorithm = token;
+            continue;
+        }
+
+        char* end = nullptr;
+        long capacity = std::strtol(token.c_str(), &end, 10);
+        long initial = 0;
+        if (*end == ':') initial = std::strtol(end + 1, &end, 10);
+        if (*end != '\0' || capacity <= 0 || capacity > 0xFFFF || initial < 0 || initial > capacity) {
+            error = "bad jar '" + token + "'";
+            return false;
+        }
+        out.jars.push_back(Jar(static_cast<int>(out.jars.size()), static_cast<int>(capacity), static_cast<int>(initial)));
+    }
+
+    if (out.jars.empty()) {
+        error = "no jars";
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += s[i];
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += s[i];
+        }
+    }
+    return out + "\"";
+}
+
+class BatchRunner {
+public:
+    BatchRunner(int threads, std::ostream& o) : pool(threads), out(o) {
+        for (int w = 0; w < pool.size(); ++w) {
+            contexts.push_back(std::unique_ptr<SearchAlgorithms>(new SearchAlgorithms()));
+            contexts[w]->verbose = false;
+        }
+    }
+
+    void submit(const BatchInstance& instance) {
+        pool.submit([this, instance](int w) { solve(*contexts[w], instance); });
+    }
+
+    void wait() { pool.wait(); }
+
+    void write(const std::string& line) {
+        std::lock_guard<std::mutex> lock(out_mutex);
+        out << line << "\n";
+        out.flush();
+    }
+
+private:
+    WorkStealingPool pool;
+    std::vector<std::unique_ptr<SearchAlgorithms> > contexts; // one per pool worker
+    std::ostream& out;
+    std::mutex out_mutex;
+
+    void solve(SearchAlgorithms& search, const BatchInstance& instance) {
+        const SearchAlgorithmEntry* algorithm = find_search_algorithm(instance.algorithm);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        algorithm->run(search, instance.jars);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        int goal = search.find_goal();
+        std::ostringstream line;
+        line << "{\"line\":" << instance.line << ",\"algorithm\":" << json_string(instance.algorithm) << ",\"capacities\":[";
+        for (size_t j = 0; j < instance.jars.size(); ++j) line << (j ? "," : "") << instance.jars[j].max_capacity;
+        line << "],\"initial\":[";
+        for (size_t j = 0; j < instance.jars.size(); ++j) line << (j ? "," : "") << instance.jars[j].current_value;
+        line << "],\"solved\":" << (goal != -1 ? "true" : "false");
+        if (goal != -1) {
+            line << ",\"cost\":" << search.medidas.custoCaminho << ",\"depth\":" << search.medidas.profundidadeMax;
+        }
+        search.medidas.tempoExecucao = std::chrono::duration<double, std::milli>(end - start).count();
+        line << ",\"nodes\":" << search.nodes.size() << ",\"time_ms\":" << search.medidas.tempoExecucao << ",\"stats\":";
+        search.medidas.escreverJson(line);
+        line << "}";
+        search.nodes.clear();
+        write(line.str());
+    }
+};
+
+} // namespace
+
+int run_batch(const BatchOptions& options, std::istream& in, std::ostream& out) {
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    BatchRunner runner(threads > 0 ? threads : 1, out);
+
+    int errors = 0;
+    int line_number = 0;
+    std::string text;
+    while (std::getline(in, text)) {
+        ++line_number;
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos || text[first] == '#') continue;
+
+        BatchInstance instance;
+        std::string error;
+        instance.line = line_number;
+        if (!parse_batch_line(text, options.algorithm, instance, error)) {
+            ++errors;
+            runner.write("{\"line\":" + std::to_string(line_number) + ",\"error\":" + json_string(error) + "}");
+            continue;
+        }
+        runner.submit(instance);
+    }
+    runner.wait();
+    return errors;
+}
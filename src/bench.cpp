@@ -0,0 +1,319 @@
+#include "algorithm_registry.hpp"
+#include "executor.hpp"
+#include "instance_generator.hpp"
+#include "jar_kernel.hpp"
+#include "search_trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+// Benchmark driver: generates instances and times every selected algorithm on
+// each of them. Results go to stdout as CSV or JSON.
+
+// Backtracking and depth-limited DFS are tree searches whose run time explodes
+// on most generated instances, so they only run when asked for
+static const char* kDefaultAlgorithms = "bfs,ucs,greedy,astar,ida";
+
+struct BenchOptions {
+    InstanceParams instance;
+    int instances = 5;
+    int warmup = 1;
+    int reps = 5;
+    int threads = 1;
+    HeuristicKind heuristic = HEURISTIC_ADJACENT;
+    bool json = false;
+    std::vector<std::string> algorithms;
+    std::string progress_path;
+    int progress_interval_ms = 1000;
+    std::string trace_path;
+    int sma_limits = 0; // > 0: check SMA* at node limits 2 .. sma_limits instead of timing
+};
+
+struct BenchResult {
+    int instance;
+    std::string capacities;
+    std::string algorithm;
+    bool solved;
+    int cost;
+    MedidasBusca stats; // counters of the last run
+    double wall_ms_min;
+    double wall_ms_median;
+    double nodes_per_sec;
+    long peak_rss_kb;
+};
+
+static void usage(const char* argv0) {
+    std::cerr << "usage: " << argv0 << " [options]\n"
+              << "  --jars N             jars per instance (default 4)\n"
+              << "  --min-cap N          smallest capacity (default 2)\n"
+              << "  --max-cap N          largest capacity (default 9)\n"
+              << "  --random-fill        random initial values instead of empty jars\n"
+              << "  --solvable-only      skip instances whose goal is unreachable\n"
+              << "  --max-states N       state budget of the solvability check\n"
+              << "  --seed N             generator seed (default 1)\n"
+              << "  --instances N        number of instances (default 5)\n"
+              << "  --warmup N           untimed runs per algorithm (default 1)\n"
+              << "  --reps N             timed runs per algorithm (default 5)\n"
+              << "  --threads N          threads for bfs, astar and ida (default 1)\n"
+              << "  --heuristic NAME     steps, volume, adjacent or pdb (default adjacent)\n"
+              << "  --algorithms a,b,..  subset of:";
+    const std::vector<SearchAlgorithmEntry>& entries = search_algorithms();
+    for (size_t i = 0; i < entries.size(); ++i) std::cerr << " " << entries[i].name;
+    std::cerr << "\n                       (default " << kDefaultAlgorithms << ")\n"
+              << "  --format csv|json    output format (default csv)\n"
+              << "  --progress FILE      JSON lines with live search progress (\"-\" = stderr)\n"
+              << "  --progress-ms N      progress sampling interval (default 1000)\n"
+              << "  --trace FILE         Chrome trace of IDA* iterations, BFS layers and A* f-layers\n"
+              << "  --sma-limits N       check SMA* at node limits 2..N against the cheapest path that fits\n";
+}
+
+static bool parse_algorithms(const std::string& names, std::vector<std::string>& out) {
+    std::stringstream list(names);
+    std::string name;
+    while (std::getline(list, name, ',')) {
+        if (!find_search_algorithm(name)) {
+            std::cerr << "unknown algorithm: " << name << "\n";
+            return false;
+        }
+        out.push_back(name);
+    }
+    return true;
+}
+
+static bool parse_options(int argc, char** argv, BenchOptions& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--random-fill") opt.instance.random_fill = true;
+        else if (arg == "--solvable-only") opt.instance.solvable_only = true;
+        else if (!has_value) return false;
+        else if (arg == "--jars") opt.instance.jars = std::atoi(argv[++i]);
+        else if (arg == "--min-cap") opt.instance.min_capacity = std::atoi(argv[++i]);
+        else if (arg == "--max-cap") opt.instance.max_capacity = std::atoi(argv[++i]);
+        else if (arg == "--max-states") opt.instance.max_states = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seed") opt.instance.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--instances") opt.instances = std::atoi(argv[++i]);
+        else if (arg == "--warmup") opt.warmup = std::atoi(argv[++i]);
+        else if (arg == "--reps") opt.reps = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--threads") opt.threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--format") opt.json = std::string(argv[++i]) == "json";
+        else if (arg == "--progress") opt.progress_path = argv[++i];
+        else if (arg == "--progress-ms") opt.progress_interval_ms = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--trace") opt.trace_path = argv[++i];
+        else if (arg == "--sma-limits") opt.sma_limits = std::atoi(argv[++i]);
+        else if (arg == "--heuristic") {
+            if (!parse_heuristic(argv[++i], opt.heuristic)) return false;
+        } else if (arg == "--algorithms") {
+            if (!parse_algorithms(argv[++i], opt.algorithms)) return false;
+        } else {
+            return false;
+        }
+    }
+    if (opt.instance.jars < 1 || opt.instance.min_capacity < 1 || opt.instance.max_capacity < opt.instance.min_capacity) return false;
+    if (opt.algorithms.empty()) parse_algorithms(kDefaultAlgorithms, opt.algorithms);
+    return true;
+}
+
+// Resets the kernel's peak RSS counter (Linux 4.0+); harmless elsewhere
+static void reset_peak_rss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if (clear_refs) clear_refs << "5";
+}
+
+// Peak resident set size in kB: VmHWM, or the process-wide maximum from getrusage
+static long peak_rss_kb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::atol(line.c_str() + 6);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static std::string capacities_of(const std::vector<Jar>& jars) {
+    std::string out;
+    for (size_t i = 0; i < jars.size(); ++i) {
+        if (i) out += "|";
+        out += std::to_string(jars[i].max_capacity);
+        if (jars[i].current_value) out += ":" + std::to_string(jars[i].current_value);
+    }
+    return out;
+}
+
+static BenchResult run_algorithm(SearchAlgorithms& search, const BenchOptions& opt, int instance, const std::vector<Jar>& jars,
+                                 const SearchAlgorithmEntry& algorithm) {
+    for (int w = 0; w < opt.warmup; ++w) algorithm.run(search, jars);
+
+    reset_peak_rss();
+    std::vector<double> wall_ms;
+    for (int r = 0; r < opt.reps; ++r) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        algorithm.run(search, jars);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        wall_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(wall_ms.begin(), wall_ms.end());
+
+    BenchResult result;
+    result.instance = instance;
+    result.capacities = capacities_of(jars);
+    result.algorithm = algorithm.name;
+    result.peak_rss_kb = peak_rss_kb();
+    result.wall_ms_min = wall_ms.front();
+    result.wall_ms_median = wall_ms[wall_ms.size() / 2];
+
+    // Counts of the last run, kept by the search itself
+    result.stats = search.medidas;
+    result.stats.tempoExecucao = result.wall_ms_median;
+    result.solved = search.find_goal() != -1;
+    result.cost = result.solved ? search.medidas.custoCaminho : -1;
+    // Expansions per second, from the progress counter that STATS=0 keeps
+    uint64_t expansions = search.progress.expansions_so_far();
+    result.nodes_per_sec = result.wall_ms_median > 0 ? expansions / (result.wall_ms_median / 1000.0) : 0;
+    return result;
+}
+
+static void write_csv_header(std::ostream& out) {
+    out << "instance,capacities,algorithm,solved,cost,generated,expanded,duplicates,stale_pops,reopenings,mean_probe_length,"
+           "peak_open,peak_closed,iterations,wall_ms_min,wall_ms_median,nodes_per_sec,peak_rss_kb,arena_bytes,arena_peak_bytes\n";
+}
+
+static void write_csv(std::ostream& out, const BenchResult& r) {
+    const MedidasBusca& s = r.stats;
+    out << r.instance << "," << r.capacities << "," << r.algorithm << "," << (r.solved ? 1 : 0) << "," << r.cost << ","
+        << s.totalFilhosGerados << "," << s.nosExpandidos << "," << s.duplicados << "," << s.retiradasObsoletas << ","
+        << s.reaberturas << "," << s.sondagemMedia() << "," << s.picoAbertos << "," << s.picoFechados << ","
+        << s.iteracoes << "," << r.wall_ms_min << "," << r.wall_ms_median << ","
+        << static_cast<long long>(r.nodes_per_sec) << "," << r.peak_rss_kb << "," << s.bytesArena << ","
+        << s.picoBytesArena << "\n";
+}
+
+static void write_json(std::ostream& out, const BenchResult& r) {
+    out << "{\"instance\":" << r.instance << ",\"capacities\":\"" << r.capacities << "\",\"algorithm\":\"" << r.algorithm
+        << "\",\"solved\":" << (r.solved ? "true" : "false") << ",\"cost\":" << r.cost << ",\"wall_ms_min\":" << r.wall_ms_min
+        << ",\"wall_ms_median\":" << r.wall_ms_median << ",\"nodes_per_sec\":" << static_cast<long long>(r.nodes_per_sec)
+        << ",\"peak_rss_kb\":" << r.peak_rss_kb << ",\"stats\":";
+    r.stats.escreverJson(out);
+    out << "}";
+}
+
+// Cheapest solution over paths of at most `nodes` nodes, -1 if there is none:
+// Bellman-Ford over the whole state space, one round per action
+static int cheapest_within(const std::vector<Jar>& jars, int nodes) {
+    typedef std::vector<uint16_t> State;
+    GenericJarKernel kernel(jars);
+    std::map<State, int> cost;
+    cost[kernel.initial_state()] = 0;
+    for (int round = 1; round < nodes; ++round) {
+        std::map<State, int> next = cost;
+        State child = kernel.make_state();
+        for (std::map<State, int>::const_iterator it = cost.begin(); it != cost.end(); ++it) {
+            kernel.for_each_successor(it->first.data(), child.data(), [&](const uint16_t* c, int step, int, int) {
+                State key(c, c + jars.size());
+                std::map<State, int>::iterator found = next.find(key);
+                if (found == next.end()) next[key] = it->second + step;
+                else found->second = std::min(found->second, it->second + step);
+            });
+        }
+        cost.swap(next);
+    }
+    int best = -1;
+    for (std::map<State, int>::const_iterator it = cost.begin(); it != cost.end(); ++it) {
+        if (kernel.is_goal(it->first.data()) && (best == -1 || it->second < best)) best = it->second;
+    }
+    return best;
+}
+
+// --sma-limits: SMA* must return, and with the cheapest solution whose path
+// fits in the pool (the optimal one whenever that fits). Returns the number
+// of mismatches, each printed as CSV.
+static int check_sma(SearchAlgorithms& search, const BenchOptions& opt, InstanceGenerator& generator) {
+    std::vector<Jar> jars;
+    int mismatches = 0;
+    std::cout << "instance,capacities,node_limit,expected,cost,expanded\n";
+    for (int instance = 0; instance < opt.instances; ++instance) {
+        if (!generator.next(jars)) break;
+        for (int limit = 2; limit <= opt.sma_limits; ++limit) {
+            search.sma_node_limit = limit;
+            search.solve_with_sma_star(jars);
+            int cost = search.find_goal() == -1 ? -1 : search.medidas.custoCaminho;
+            int expected = cheapest_within(jars, limit);
+            if (cost == expected) continue;
+            ++mismatches;
+            std::cout << instance << "," << capacities_of(jars) << "," << limit << "," << expected << "," << cost << ","
+                      << search.medidas.nosExpandidos << "\n";
+        }
+    }
+    std::cerr << mismatches << " SMA* mismatches\n";
+    return mismatches;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    if (!parse_options(argc, argv, opt)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // One search context for every run, so a single sampler can watch it
+    SearchAlgorithms search;
+    search.verbose = false;
+    search.bfs_threads = opt.threads;
+    search.astar_threads = opt.threads;
+    search.ida_threads = opt.threads;
+    search.heuristic_kind = opt.heuristic;
+
+    SearchTrace trace;
+    if (!opt.trace_path.empty()) search.trace = &trace;
+    std::unique_ptr<ProgressSampler> sampler;
+    if (!opt.progress_path.empty()) {
+        sampler.reset(new ProgressSampler(search.progress, opt.progress_path, opt.progress_interval_ms));
+        if (!sampler->ok()) {
+            std::cerr << "cannot open " << opt.progress_path << "\n";
+            return 1;
+        }
+    }
+
+    std::ostream& out = std::cout;
+    InstanceGenerator generator(opt.instance);
+    if (opt.sma_limits > 0) return check_sma(search, opt, generator) ? 1 : 0;
+    std::vector<Jar> jars;
+    bool first = true;
+    if (opt.json) out << "[\n";
+    else write_csv_header(out);
+
+    for (int instance = 0; instance < opt.instances; ++instance) {
+        if (!generator.next(jars)) {
+            std::cerr << "no acceptable instance found after instance " << instance << "\n";
+            break;
+        }
+        for (size_t a = 0; a < opt.algorithms.size(); ++a) {
+            BenchResult result = run_algorithm(search, opt, instance, jars, *find_search_algorithm(opt.algorithms[a]));
+            if (opt.json) {
+                out << (first ? "  " : ",\n  ");
+                write_json(out, result);
+            } else {
+                write_csv(out, result);
+            }
+            out.flush();
+            first = false;
+        }
+    }
+    if (opt.json) out << "\n]\n";
+    if (!opt.trace_path.empty() && !trace.write(opt.trace_path)) {
+        std::cerr << "cannot write " << opt.trace_path << "\n";
+        return 1;
+    }
+    return 0;
+}
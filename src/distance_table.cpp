@@ -0,0 +1,263 @@
+#include "distance_table.hpp"
+#include "executor.hpp"
+#include "jar_kernel.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// File layout: header, capacities (uint16 each), padding to 8 bytes,
+// distances (uint32 per state), best actions (uint8 per state)
+const char kMagic[8] = {'W', 'J', 'D', 'I', 'S', 'T', '0', '1'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t jars;
+    uint32_t reserved;
+    uint64_t states;
+};
+
+size_t distances_offset(size_t jars) {
+    size_t end = sizeof(FileHeader) + jars * sizeof(uint16_t);
+    return (end + 7) & ~static_cast<size_t>(7);
+}
+
+} // namespace
+
+const uint32_t DistanceTable::kUnreachable;
+const uint8_t DistanceTable::kNoAction;
+
+DistanceTable::DistanceTable(const std::vector<Jar>& jars)
+    : state_codec(jars), states(0), dist(nullptr), act(nullptr), mapping(nullptr), mapping_size(0) {
+    for (const Jar& jar : jars) caps.push_back(static_cast<uint16_t>(jar.max_capacity));
+}
+
+DistanceTable::~DistanceTable() {
+    if (mapping) munmap(mapping, mapping_size);
+}
+
+bool DistanceTable::matches(const std::vector<Jar>& jars) const {
+    if (jars.size() != caps.size()) return false;
+    for (size_t j = 0; j < jars.size(); ++j) {
+        if (jars[j].max_capacity != caps[j]) return false;
+    }
+    return true;
+}
+
+std::string DistanceTable::file_name(const std::vector<Jar>& jars) {
+    std::string name = "water_jug_dist";
+    for (const Jar& jar : jars) name += "_" + std::to_string(jar.max_capacity);
+    return name + ".bin";
+}
+
+// Dijkstra on the reversed action graph: popping a state settles its exact
+// cost to the goal, and each predecessor reached through action k learns
+// that k is its best first move if that improves its distance.
+//
+// Predecessors of a state s:
+//   empty jar i:    s[i] == 0, the jar held 1..cap[i]
+//   fill jar i:     s[i] == cap[i], the jar held 0..cap[i]-1
+//   pour src->dst:  the pour stops when src runs dry or dst is full, so
+//                   s[src] == 0 or s[dst] == cap[dst]; t units moved, with
+//                   1 <= t <= min(cap[src] - s[src], s[dst])
+std::unique_ptr<DistanceTable> DistanceTable::build(const std::vector<Jar>& jars, uint64_t max_states) {
+    if (!kernel_supports(jars)) return nullptr;
+    std::unique_ptr<DistanceTable> table(new DistanceTable(jars));
+    const StateCodec& codec = table->state_codec;
+    if (!codec.rankable() || codec.state_count() > max_states) return nullptr;
+
+    GenericJarKernel kernel(jars);
+    const int n = kernel.num_jars();
+    const int m = kernel.num_actions();
+    const uint16_t* cap = table->caps.data();
+    std::vector<uint64_t> stride(n);
+    for (int j = 0; j < n; ++j) stride[j] = codec.jar_stride(j);
+
+    table->states = codec.state_count();
+    table->own_dist.assign(table->states, kUnreachable);
+    table->own_act.assign(table->states, kNoAction);
+    uint32_t* dist = table->own_dist.data();
+    uint8_t* act = table->own_act.data();
+
+    // Dial's algorithm: an action costs at most the largest capacity, so
+    // max_capacity + 1 circular buckets hold every open distance
+    std::vector<std::vector<uint64_t> > buckets(kernel.max_capacity() + 1);
+    size_t open = 0;
+    uint64_t d = 0;
+    auto relax = [&](uint64_t p, int cost, int k) {
+        uint64_t nd = d + cost;
+        if (nd >= dist[p]) return;
+        dist[p] = static_cast<uint32_t>(nd);
+        act[p] = static_cast<uint8_t>(k);
+        buckets[nd % buckets.size()].push_back(p);
+        ++open;
+    };
+
+    std::vector<uint16_t> s(n, static_cast<uint16_t>(kernel.target()));
+    uint64_t goal = codec.rank(s.data());
+    dist[goal] = 0;
+    buckets[0].push_back(goal);
+    open = 1;
+
+    for (; open > 0; ++d) {
+        std::vector<uint64_t>& bucket = buckets[d % buckets.size()];
+        while (!bucket.empty()) {
+            uint64_t r = bucket.back();
+            bucket.pop_back();
+            --open;
+            if (dist[r] != d) continue; // stale entry
+            codec.unrank(r, s.data());
+
+            for (int k = 0; k < m; ++k) {
+                const JarAction& a = kernel.action(k);
+                const int i = a.jar;
+                if (a.type == ACTION_EMPTY) {
+                    if (s[i] != 0) continue;
+                    for (int held = 1; held <= cap[i]; ++held) relax(r + held * stride[i], held, k);
+                } else if (a.type == ACTION_FILL) {
+                    if (s[i] != cap[i]) continue;
+                    for (int held = 0; held < cap[i]; ++held) relax(r - (cap[i] - held) * stride[i], cap[i] - held, k);
+                } else {
+                    const int dst = (a.type == ACTION_TRANSFER_LEFT) ? i - 1 : i + 1;
+                    if (s[i] != 0 && s[dst] != cap[dst]) continue;
+                    int max_moved = std::min(cap[i] - s[i], static_cast<int>(s[dst]));
+                    for (int t = 1; t <= max_moved; ++t) relax(r + t * stride[i] - t * stride[dst], t, k);
+                }
+            }
+        }
+    }
+
+    table->dist = dist;
+    table->act = act;
+    return table;
+}
+
+bool DistanceTable::save(const std::string& path) const {
+    // Written under a temporary name and renamed, so readers never map a partial file
+    std::string tmp = path + ".tmp" + std::to_string(getpid());
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.jars = static_cast<uint32_t>(caps.size());
+    header.reserved = 0;
+    header.states = states;
+    const char padding[8] = {0};
+    size_t pad = distances_offset(caps.size()) - sizeof(FileHeader) - caps.size() * sizeof(uint16_t);
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1
+        && std::fwrite(caps.data(), sizeof(uint16_t), caps.size(), f) == caps.size()
+        && std::fwrite(padding, 1, pad, f) == pad
+        && std::fwrite(dist, sizeof(uint32_t), states, f) == states
+        && std::fwrite(act, sizeof(uint8_t), states, f) == states;
+    ok = (std::fclose(f) == 0) && ok;
+    if (ok) ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok) std::remove(tmp.c_str());
+    return ok;
+}
+
+std::unique_ptr<DistanceTable> DistanceTable::load(const std::string& path, const std::vector<Jar>& jars) {
+    if (!kernel_supports(jars)) return nullptr;
+    std::unique_ptr<DistanceTable> table(new DistanceTable(jars));
+    const StateCodec& codec = table->state_codec;
+    if (!codec.rankable()) return nullptr;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat info;
+    void* base = MAP_FAILED;
+    size_t dist_off = distances_offset(jars.size());
+    size_t expected = dist_off + codec.state_count() * (sizeof(uint32_t) + sizeof(uint8_t));
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) == expected) {
+        base = mmap(nullptr, expected, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) return nullptr;
+    table->mapping = base;
+    table->mapping_size = expected;
+
+    const char* bytes = static_cast<const char*>(base);
+    FileHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.jars != jars.size()
+        || header.states != codec.state_count()) {
+        return nullptr;
+    }
+    if (std::memcmp(bytes + sizeof(header), table->caps.data(), jars.size() * sizeof(uint16_t)) != 0) return nullptr;
+
+    table->states = header.states;
+    table->dist = reinterpret_cast<const uint32_t*>(bytes + dist_off);
+    table->act = reinterpret_cast<const uint8_t*>(bytes + dist_off + table->states * sizeof(uint32_t));
+    return table;
+}
+
+// Looks the table up (memory, then distance_table_dir, then builds it) and
+// walks the best actions from the initial state. The arena ends up holding
+// just the solution path, f = g + exact remaining cost.
+void SearchAlgorithms::solve_with_distance_table(const std::vector<Jar>& initial_jars) {
+    begin_search();
+    if (initial_jars.empty()) return;
+    if (!kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instance not supported by the search kernels.\n";
+        return;
+    }
+
+    if (!distance_table || !distance_table->matches(initial_jars)) {
+        distance_table.reset();
+        std::string path;
+        if (!distance_table_dir.empty()) path = distance_table_dir + "/" + DistanceTable::file_name(initial_jars);
+        std::unique_ptr<DistanceTable> table;
+        if (!path.empty()) table = DistanceTable::load(path, initial_jars);
+        if (!table) {
+            table = DistanceTable::build(initial_jars, distance_table_limit);
+            if (table && !path.empty() && !table->save(path) && verbose) {
+                std::cout << "Could not write distance table " << path << "\n";
+            }
+        }
+        if (!table) {
+            record_goal(-1);
+            if (verbose) std::cout << "State space too large for a distance table.\n";
+            return;
+        }
+        distance_table = std::move(table);
+    }
+
+    const DistanceTable& table = *distance_table;
+    GenericJarKernel kernel(initial_jars);
+    GenericJarKernel::State current = kernel.initial_state();
+    GenericJarKernel::State next = current;
+    uint32_t remaining = table.cost_to_goal(current.data());
+    nodes.reset(initial_jars);
+    if (remaining == DistanceTable::kUnreachable) {
+        record_goal(-1);
+        if (verbose) std::cout << "No solution found.\n";
+        return;
+    }
+
+    int g = 0;
+    int parent = -1;
+    while (true) {
+        int idx = nodes.add(current.data(), parent, g, g + static_cast<int>(remaining));
+        nodes.set_visited(idx);
+        medidas.guardou();
+        uint8_t k = table.best_action(current.data());
+        if (k == DistanceTable::kNoAction) { // at the goal
+            record_goal(idx);
+            break;
+        }
+        nodes.set_closed(idx);
+        medidas.expandiu();
+        progress.expanded(0);
+        next = current;
+        g += kernel.apply_action(k, current.data(), next.data());
+        current.swap(next);
+        remaining = table.cost_to_goal(current.data());
+        parent = idx;
+    }
+}
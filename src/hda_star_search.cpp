@@ -0,0 +1,308 @@
+#include "executor.hpp"
+#include "flat_state_table.hpp"
+#include "jar_kernel.hpp"
+#include "mpsc_queue.hpp"
+#include "open_list.hpp"
+#include <atomic>
+#include <climits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Child forwarded to the worker that owns its state
+struct HdaMessage {
+    PackedState key;
+    int g_cost;
+    int parent; // global node id: local index * workers + worker
+};
+
+// Hash-distributed A* (HDA*). Every state is owned by one worker, chosen by
+// its hash; each worker has its own open list, closed table and node arena,
+// and sends generated children to their owner in batches through lock-free
+// MPSC inboxes.
+//
+// Termination: `work` counts active workers plus messages in flight. A worker
+// only goes inactive when its open list holds nothing below the incumbent goal
+// cost, and it becomes active again before taking a batch off its inbox, so
+// `work` reaching zero means no node with f < incumbent exists anywhere. As in
+// solve_with_astar, children with f >= incumbent are pruned, so with an
+// admissible heuristic the incumbent is optimal at that point.
+template <class OpenList, class Kernel>
+class HdaStar {
+public:
+    HdaStar(const Kernel& k, const StateCodec& c, const std::vector<Jar>& jars, int threads, BucketQueue::TieBreak tie,
+            SearchProgress& p)
+        : kernel(k), codec(c), progress(p), num_workers(std::max(1, threads)), work(num_workers),
+          incumbent(INT_MAX), done(false) {
+        for (int w = 0; w < num_workers; ++w) {
+            workers.push_back(std::unique_ptr<Worker>(new Worker(tie)));
+            workers[w]->nodes.reset(jars);
+            workers[w]->table.reserve(table_estimate(codec) / num_workers);
+            workers[w]->table.count_probes(MedidasBusca::kAtivas); // only its owner touches it
+            workers[w]->outbox.resize(num_workers);
+        }
+    }
+
+    // Stores the cheapest goal's path in `out` and returns its index, or -1
+    int run(NodeArena& out, MedidasBusca& stats) {
+        typename Kernel::State initial = kernel.initial_state();
+        PackedState root_key = codec.encode(initial.data());
+        Worker& root_owner = *workers[owner(root_key)];
+        insert(root_owner, root_key, initial.data(), 0, kernel.heuristic(initial.data()), -1);
+
+        std::vector<std::thread> threads;
+        for (int w = 1; w < num_workers; ++w) threads.push_back(std::thread(&HdaStar::worker_loop, this, w));
+        worker_loop(0);
+        for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+
+        for (int w = 0; w < num_workers; ++w) {
+            Worker& worker = *workers[w];
+            worker.stats.sondagens(worker.table.probe_lookups(), worker.table.probe_steps());
+            worker.stats.fechados(worker.stats.nosExpandidos);
+            stats.somar(worker.stats);
+        }
+        return store_path(out);
+    }
+
+private:
+    static const size_t kBatchSize = 64; // messages per inbox push
+    static const int kFlushEvery = 32;   // expansions between outbox flushes
+
+    typedef MpscQueue<std::vector<HdaMessage> > Inbox;
+
+    struct Worker {
+        NodeArena nodes;
+        FlatStateTable<int> table;
+        OpenList open;
+        Inbox inbox;
+        std::vector<std::vector<HdaMessage> > outbox;
+        bool active;
+        int goal;   // cheapest goal this worker expanded, local index
+        int goal_g;
+        MedidasBusca stats;
+        explicit Worker(BucketQueue::TieBreak tie) : open(tie, nullptr), active(true), goal(-1), goal_g(INT_MAX) {}
+    };
+
+    const Kernel& kernel;
+    const StateCodec& codec;
+    SearchProgress& progress;
+    int num_workers;
+    std::vector<std::unique_ptr<Worker> > workers;
+    std::atomic<long> work;
+    std::atomic<int> incumbent;
+    std::atomic<bool> done;
+
+    int owner(const PackedState& key) const {
+        return static_cast<int>((PackedStateHash()(key) >> 40) % static_cast<size_t>(num_workers));
+    }
+
+    void insert(Worker& self, const PackedState& key, const uint16_t* values, int g, int f, int parent) {
+        int* existing = self.table.find(key);
+        if (existing) {
+            int idx = *existing;
+            if (g >= self.nodes.g_cost(idx)) {
+                self.stats.duplicado();
+                return;
+            }
+            self.nodes.set_g_cost(idx, g);
+            self.nodes.set_f_cost(idx, f);
+            self.nodes.set_parent(idx, parent);
+            if (self.nodes.closed(idx)) {
+                // Expanded with a worse g by now: reopen
+                self.nodes.set_closed(idx, false);
+                self.open.push(idx, f);
+                self.stats.reabriu();
+            } else {
+                self.open.update(idx, f);
+            }
+            return;
+        }
+        int idx = self.nodes.add(values, parent, g, f);
+        self.table.insert(key, idx);
+        self.open.push(idx, f);
+        self.stats.guardou();
+        self.stats.abertos(self.open.size());
+    }
+
+    void flush(int dest, Worker& self) {
+        std::vector<HdaMessage>& batch = self.outbox[dest];
+        if (batch.empty()) return;
+        typename Inbox::Node* node = new typename Inbox::Node();
+        node->value.swap(batch);
+        batch.reserve(kBatchSize);
+        work.fetch_add(static_cast<long>(node->value.size()));
+        workers[dest]->inbox.push(node);
+    }
+
+    void flush_all(Worker& self) {
+        for (int d = 0; d < num_workers; ++d) flush(d, self);
+    }
+
+    void record_goal(int g) {
+        int best = incumbent.load();
+        while (g < best && !incumbent.compare_exchange_weak(best, g)) {}
+        progress.improve_best(g);
+    }
+
+    // Expands the best node below the incumbent, if any
+    bool expand_one(int w, Worker& self, typename Kernel::State& current, typename Kernel::State& scratch) {
+        while (!self.open.empty()) {
+            if (self.open.top_f() >= incumbent.load(std::memory_order_relaxed)) return false;
+            std::pair<int, int> top = self.open.pop();
+            int idx = top.first;
+            if (top.second > self.nodes.f_cost(idx) || self.nodes.closed(idx)) { // stale
+                self.stats.retiradaObsoleta();
+                continue;
+            }
+
+            self.nodes.set_closed(idx);
+            self.nodes.set_visited(idx);
+            self.nodes.load_values(idx, current.data());
+            int g = self.nodes.g_cost(idx);
+            if (kernel.is_goal(current.data())) {
+                if (g < self.goal_g) {
+                    self.goal = idx;
+                    self.goal_g = g;
+                }
+                record_goal(g);
+                return true;
+            }
+
+            self.stats.expandiu();
+            int parent = idx * num_workers + w;
+            JarHeuristicTerms terms = kernel.heuristic_terms(current.data());
+            kernel.for_each_successor(current.data(), scratch.data(), [&](const uint16_t* child, int cost, int jar, int type) {
+                self.stats.gerou();
+                int child_g = g + cost;
+                int child_f = child_g + kernel.child_heuristic(terms, current.data(), child, jar, type);
+                if (child_f >= incumbent.load(std::memory_order_relaxed)) return;
+                PackedState key = codec.encode(child);
+                int dest = owner(key);
+                if (dest == w) {
+                    insert(self, key, child, child_g, child_f, parent);
+                } else {
+                    HdaMessage msg = {key, child_g, parent};
+                    self.outbox[dest].push_back(msg);
+                    if (self.outbox[dest].size() >= kBatchSize) flush(dest, self);
+                }
+            });
+            return true;
+        }
+        return false;
+    }
+
+    void worker_loop(int w) {
+        Worker& self = *workers[w];
+        typename Kernel::State current = kernel.make_state();
+        typename Kernel::State scratch = kernel.make_state();
+        typename Kernel::State received = kernel.make_state();
+        int expansions = 0;
+
+        while (!done.load(std::memory_order_acquire)) {
+            while (typename Inbox::Node* node = self.inbox.pop()) {
+                if (!self.active) {
+                    work.fetch_add(1);
+                    self.active = true;
+                }
+                const std::vector<HdaMessage>& batch = node->value;
+                for (size_t m = 0; m < batch.size(); ++m) {
+                    codec.decode(batch[m].key, received.data());
+                    int f = batch[m].g_cost + kernel.heuristic(received.data());
+                    if (f >= incumbent.load(std::memory_order_relaxed)) continue;
+                    insert(self, batch[m].key, received.data(), batch[m].g_cost, f, batch[m].parent);
+                }
+                long consumed = static_cast<long>(batch.size());
+                delete node;
+                work.fetch_sub(consumed);
+            }
+
+            if (expand_one(w, self, current, scratch)) {
+                if (++expansions % kFlushEvery == 0) {
+                    flush_all(self);
+                    progress.add_expansions(kFlushEvery);
+                }
+                continue;
+            }
+
+            // Nothing useful left locally: hand over pending children, then go idle
+            flush_all(self);
+            if (self.active) {
+                self.active = false;
+                if (work.fetch_sub(1) == 1) done.store(true, std::memory_order_release);
+            } else if (work.load() == 0) {
+                done.store(true, std::memory_order_release);
+            }
+            std::this_thread::yield();
+        }
+        progress.add_expansions(expansions % kFlushEvery);
+    }
+
+    // Copies the cheapest goal's path, root first, into `out`, following the
+    // global parent ids across workers. Returns the goal's index, or -1.
+    int store_path(NodeArena& out) const {
+        int goal = -1;
+        int goal_g = INT_MAX;
+        for (int w = 0; w < num_workers; ++w) {
+            if (workers[w]->goal != -1 && workers[w]->goal_g < goal_g) {
+                goal = workers[w]->goal * num_workers + w;
+                goal_g = workers[w]->goal_g;
+            }
+        }
+        if (goal == -1) return -1;
+
+        std::vector<int> path;
+        for (int id = goal; id != -1; id = workers[id % num_workers]->nodes.parent(id / num_workers)) path.push_back(id);
+        typename Kernel::State values = kernel.make_state();
+        int first = out.size();
+        for (size_t d = path.size(); d-- > 0;) {
+            const NodeArena& local = workers[path[d] % num_workers]->nodes;
+            int i = path[d] / num_workers;
+            local.load_values(i, values.data());
+            int idx = out.add(values.data(), out.size() == first ? -1 : out.size() - 1, local.g_cost(i), local.f_cost(i));
+            out.set_visited(idx);
+            if (d > 0) out.set_closed(idx);
+        }
+        return out.size() - 1;
+    }
+};
+
+struct HdaStarRunner {
+    NodeArena& nodes;
+    MedidasBusca& stats;
+    const StateCodec& codec;
+    const std::vector<Jar>& jars;
+    int threads;
+    SearchAlgorithms::OpenListKind open_list;
+    BucketQueue::TieBreak tie;
+    SearchProgress& progress;
+    int goal;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        if (open_list == SearchAlgorithms::BUCKET_QUEUE) {
+            HdaStar<BucketOpenList, Kernel> search(kernel, codec, jars, threads, tie, progress);
+            goal = search.run(nodes, stats);
+        } else {
+            HdaStar<HeapOpenList, Kernel> search(kernel, codec, jars, threads, tie, progress);
+            goal = search.run(nodes, stats);
+        }
+    }
+};
+
+// The workers' arenas are freed when the search returns; the shared arena
+// ends up holding just the solution path.
+void SearchAlgorithms::solve_with_hda_star(const std::vector<Jar>& initial_jars, int threads) {
+    begin_search();
+    if (initial_jars.empty()) return;
+
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instance not supported by the search kernels.\n";
+        return;
+    }
+
+    nodes.reset(initial_jars);
+    HdaStarRunner runner = {nodes, medidas, codec, initial_jars, threads, astar_open_list, astar_tie_break, progress, -1};
+    with_jar_kernel(initial_jars, search_heuristic(initial_jars), runner);
+    record_goal(runner.goal);
+}
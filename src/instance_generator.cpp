@@ -0,0 +1,71 @@
+#include "instance_generator.hpp"
+#include "flat_state_table.hpp"
+#include "jar_kernel.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const int kMaxDraws = 1000; // per next() call when filtering
+
+struct SolvableRunner {
+    const StateCodec& codec;
+    bool solvable;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        typename Kernel::State current = kernel.initial_state();
+        typename Kernel::State scratch = kernel.make_state();
+        if (kernel.is_goal(current.data())) {
+            solvable = true;
+            return;
+        }
+
+        FlatStateTable<char> seen(table_estimate(codec));
+        std::vector<PackedState> frontier(1, codec.encode(current.data()));
+        seen.insert(frontier[0], 1);
+        for (size_t head = 0; head < frontier.size() && !solvable; ++head) {
+            codec.decode(frontier[head], current.data());
+            kernel.for_each_successor(current.data(), scratch.data(), [&](const uint16_t* child, int, int, int) {
+                if (solvable) return;
+                if (kernel.is_goal(child)) {
+                    solvable = true;
+                    return;
+                }
+                PackedState key = codec.encode(child);
+                if (seen.insert(key, 1)) frontier.push_back(key);
+            });
+        }
+    }
+};
+
+} // namespace
+
+InstanceGenerator::InstanceGenerator(const InstanceParams& p) : params(p), rng(p.seed) {}
+
+void InstanceGenerator::draw(std::vector<Jar>& jars) {
+    std::uniform_int_distribution<int> capacity(params.min_capacity, params.max_capacity);
+    jars.clear();
+    for (int i = 0; i < params.jars; ++i) {
+        int cap = capacity(rng);
+        int value = 0;
+        if (params.random_fill) value = std::uniform_int_distribution<int>(0, cap)(rng);
+        jars.push_back(Jar(i, cap, value));
+    }
+}
+
+bool InstanceGenerator::next(std::vector<Jar>& jars) {
+    for (int attempt = 0; attempt < kMaxDraws; ++attempt) {
+        draw(jars);
+        if (!params.solvable_only || instance_solvable(jars, params.max_states)) return true;
+    }
+    return false;
+}
+
+bool instance_solvable(const std::vector<Jar>& jars, uint64_t max_states) {
+    StateCodec codec(jars);
+    if (!codec.valid() || !kernel_supports(jars) || codec.state_count() > max_states) return false;
+    SolvableRunner runner = {codec, false};
+    with_jar_kernel(jars, runner);
+    return runner.solvable;
+}
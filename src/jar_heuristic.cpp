@@ -0,0 +1,39 @@
+#include "jar_heuristic.hpp"
+#include "executor.hpp"
+#include <iostream>
+
+static const char* const kHeuristicNames[] = {"steps", "volume", "adjacent", "pdb"};
+
+const char* heuristic_name(HeuristicKind kind) { return kHeuristicNames[kind]; }
+
+bool parse_heuristic(const std::string& name, HeuristicKind& kind) {
+    for (int k = HEURISTIC_STEPS; k <= HEURISTIC_PDB; ++k) {
+        if (name == kHeuristicNames[k]) {
+            kind = static_cast<HeuristicKind>(k);
+            return true;
+        }
+    }
+    return false;
+}
+
+// With HEURISTIC_PDB, looks the database up (memory, then pdb_dir, then
+// builds it); without one the bound falls back to the adjacent estimate
+JarHeuristic SearchAlgorithms::search_heuristic(const std::vector<Jar>& jars) {
+    if (heuristic_kind != HEURISTIC_PDB) return JarHeuristic(jars, heuristic_kind);
+
+    if (!pattern_database || !pattern_database->matches(jars, pdb_window, pdb_combine, pdb_pattern_limit)) {
+        pattern_database.reset();
+        std::string path;
+        if (!pdb_dir.empty()) path = pdb_dir + "/" + PatternDatabase::file_name(jars, pdb_window, pdb_combine);
+        std::unique_ptr<PatternDatabase> db;
+        if (!path.empty()) db = PatternDatabase::load(path, jars, pdb_window, pdb_combine, pdb_pattern_limit);
+        if (!db) {
+            db = PatternDatabase::build(jars, pdb_window, pdb_combine, pdb_pattern_limit);
+            if (db && !path.empty() && !db->save(path) && verbose) {
+                std::cout << "Could not write pattern database " << path << "\n";
+            }
+        }
+        pattern_database = std::move(db);
+    }
+    return JarHeuristic(jars, HEURISTIC_PDB, pattern_database);
+}
@@ -0,0 +1,446 @@
+#include "executor.hpp"
+#include "jar_kernel.hpp"
+#include "packed_state.hpp"
+#include "search_trace.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Sequential reader of a file of sorted PackedState records
+class LeitorRun {
+public:
+    LeitorRun(const std::string& caminho, size_t registros)
+        : arquivo(std::fopen(caminho.c_str(), "rb")), buffer(std::max<size_t>(registros, 64)), pos(0), fim(0),
+          falhou(false) {}
+    ~LeitorRun() {
+        if (arquivo) std::fclose(arquivo);
+    }
+
+    bool ok() const { return arquivo != nullptr; }
+    // A read failed: proximo() stopped early and the records seen are incomplete
+    bool falha() const { return falhou; }
+
+    bool proximo(PackedState& chave) {
+        if (pos == fim) {
+            fim = std::fread(buffer.data(), sizeof(PackedState), buffer.size(), arquivo);
+            pos = 0;
+            if (fim == 0) {
+                if (std::ferror(arquivo)) falhou = true;
+                return false;
+            }
+        }
+        chave = buffer[pos++];
+        return true;
+    }
+
+private:
+    FILE* arquivo;
+    std::vector<PackedState> buffer;
+    size_t pos;
+    size_t fim;
+    bool falhou;
+
+    LeitorRun(const LeitorRun&);
+    LeitorRun& operator=(const LeitorRun&);
+};
+
+class EscritorRun {
+public:
+    EscritorRun(const std::string& caminho, size_t registros)
+        : arquivo(std::fopen(caminho.c_str(), "wb")), escritos(0), falhou(arquivo == nullptr) {
+        buffer.reserve(std::max<size_t>(registros, 64));
+    }
+    ~EscritorRun() { fecha(); }
+
+    void escreve(const PackedState& chave) {
+        buffer.push_back(chave);
+        ++escritos;
+        if (buffer.size() == buffer.capacity()) descarrega();
+    }
+
+    // Returns false if any write failed
+    bool fecha() {
+        if (arquivo) {
+            descarrega();
+            if (std::fclose(arquivo) != 0) falhou = true;
+            arquivo = nullptr;
+        }
+        return !falhou;
+    }
+
+    size_t total() const { return escritos; }
+
+private:
+    FILE* arquivo;
+    std::vector<PackedState> buffer;
+    size_t escritos;
+    bool falhou;
+
+    void descarrega() {
+        if (buffer.empty()) return;
+        if (!falhou && std::fwrite(buffer.data(), sizeof(PackedState), buffer.size(), arquivo) != buffer.size()) falhou = true;
+        buffer.clear();
+    }
+
+    EscritorRun(const EscritorRun&);
+    EscritorRun& operator=(const EscritorRun&);
+};
+
+// Breadth-first search with delayed duplicate detection (Korf). Each layer is
+// a file of sorted, unique packed states. Expanding a layer fills a RAM
+// buffer with children, spilling it as sorted runs; the runs are then merged
+// and joined with the sorted file of every state seen so far, which yields
+// the next layer and the new visited file in one sequential pass.
+//
+// Korf's scheme only compares against the previous two layers, which relies
+// on every action being reversible. Emptying or filling a jar cannot always
+// be undone in one action, so here the join is against all earlier layers.
+template <class Kernel>
+class LarguraExterna {
+public:
+    LarguraExterna(const Kernel& k, MedidasBusca& m, SearchProgress& p, SearchTrace* t, const StateCodec& c,
+                   const std::string& d, size_t orcamento)
+        : kernel(k), medidas(m), progresso(p), trace(t), codec(c), dir(d), total_estados(0), tamanho_camada(1),
+          sequencia(0), falhou(false) {
+        size_t registros = orcamento / sizeof(PackedState);
+        buffer_expansao = std::max<size_t>(registros / 2, 1024);
+        buffer_leitura = std::max<size_t>(registros / 2 / (kMaxFanIn + 2), 64);
+    }
+
+    ~LarguraExterna() {
+        for (size_t i = 0; i < criados.size(); ++i) std::remove(criados[i].c_str());
+    }
+
+    bool falha() const { return falhou; }
+    size_t estados() const { return total_estados; }
+
+    // Returns true if the goal was reached; the path then goes to `nodes`.
+    // Only the path is kept in RAM, the layers stay on disk.
+    bool run(NodeArena& nodes) {
+        typename Kernel::State inicial = kernel.initial_state();
+        std::vector<PackedState> caminho; // goal .. root
+        std::vector<int> custos;          // action cost into caminho[i]
+
+        PackedState raiz = codec.encode(inicial.data());
+        camadas.push_back(novo_arquivo());
+        visitados = novo_arquivo();
+        {
+            EscritorRun camada(camadas[0], 1);
+            camada.escreve(raiz);
+            EscritorRun vistos(visitados, 1);
+            vistos.escreve(raiz);
+            if (!camada.fecha() || !vistos.fecha()) return erro();
+        }
+        total_estados = 1;
+        medidas.guardou();
+
+        if (kernel.is_goal(inicial.data())) {
+            caminho.push_back(raiz);
+            custos.push_back(0);
+        } else {
+            PackedState objetivo;
+            PackedState pai;
+            int custo = 0;
+            bool encontrado = false;
+            TraceLayers spans(trace, "bfs layer", "depth");
+            while (!encontrado) {
+                medidas.iteracao();
+                int profundidade = static_cast<int>(camadas.size()) - 1;
+                spans.next(profundidade);
+                progresso.set_bound(profundidade);
+                std::vector<std::string> runs;
+                encontrado = expande(camadas.back(), runs, objetivo, pai, custo);
+                if (falhou) return false;
+                if (encontrado) {
+                    for (size_t r = 0; r < runs.size(); ++r) std::remove(runs[r].c_str());
+                    break;
+                }
+                if (!proxima_camada(runs)) return false;
+            }
+            caminho.push_back(objetivo);
+            custos.push_back(custo);
+            caminho.push_back(pai);
+            // Walk back through the layers: find a predecessor in each one
+            for (int camada = static_cast<int>(camadas.size()) - 2; camada >= 0; --camada) {
+                PackedState anterior;
+                if (!predecessor(camadas[camada], caminho.back(), anterior, custo)) return erro();
+                custos.push_back(custo);
+                caminho.push_back(anterior);
+            }
+            custos.push_back(0);
+        }
+
+        // Path into the arena, root first
+        typename Kernel::State valores = kernel.make_state();
+        int g = 0;
+        for (int i = static_cast<int>(caminho.size()) - 1; i >= 0; --i) {
+            codec.decode(caminho[i], valores.data());
+            int parent = nodes.size() - 1;
+            g += custos[i];
+            int indice = nodes.add(valores.data(), parent, g, g);
+            nodes.set_visited(indice);
+            if (i > 0) nodes.set_closed(indice);
+        }
+        return true;
+    }
+
+private:
+    static const size_t kMaxFanIn = 64; // runs merged at once
+
+    const Kernel& kernel;
+    MedidasBusca& medidas;
+    SearchProgress& progresso;
+    SearchTrace* trace;
+    const StateCodec& codec;
+    std::string dir;
+    std::vector<std::string> camadas; // layer files, root first
+    std::string visitados;            // union of all layers
+    std::vector<std::string> criados; // every file created, removed at the end
+    size_t buffer_expansao;           // records buffered before spilling a run
+    size_t buffer_leitura;            // read buffer per merged file
+    size_t total_estados;
+    size_t tamanho_camada;            // states in the last layer
+    int sequencia;
+    bool falhou;
+
+    std::string novo_arquivo() {
+        char nome[32];
+        std::snprintf(nome, sizeof(nome), "/run%06d.bin", sequencia++);
+        criados.push_back(dir + nome);
+        return criados.back();
+    }
+
+    bool erro() {
+        falhou = true;
+        return false;
+    }
+
+    bool grava_run(std::vector<PackedState>& buffer, std::vector<std::string>& runs) {
+        std::sort(buffer.begin(), buffer.end());
+        size_t gerados = buffer.size();
+        buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+        if (MedidasBusca::kAtivas) medidas.duplicados += gerados - buffer.size();
+        runs.push_back(novo_arquivo());
+        EscritorRun run(runs.back(), buffer_leitura);
+        for (size_t i = 0; i < buffer.size(); ++i) run.escreve(buffer[i]);
+        buffer.clear();
+        return run.fecha() || erro();
+    }
+
+    // Expands every state of `camada` into sorted runs. Stops early when a
+    // child is the goal, reporting it with its parent and the action cost.
+    bool expande(const std::string& camada, std::vector<std::string>& runs, PackedState& objetivo, PackedState& pai, int& custo) {
+        LeitorRun leitor(camada, buffer_leitura);
+        if (!leitor.ok()) return erro();
+        typename Kernel::State atual = kernel.make_state();
+        typename Kernel::State filho = kernel.make_state();
+        std::vector<PackedState> buffer;
+        buffer.reserve(buffer_expansao);
+
+        PackedState chave;
+        bool encontrado = false;
+        while (!encontrado && leitor.proximo(chave)) {
+            codec.decode(chave, atual.data());
+            medidas.expandiu();
+            progresso.expanded(tamanho_camada);
+            kernel.for_each_successor(atual.data(), filho.data(), [&](const uint16_t* valores, int custoAcao, int, int) {
+                if (encontrado) return;
+                medidas.gerou();
+                if (kernel.is_goal(valores)) {
+                    objetivo = codec.encode(valores);
+                    pai = chave;
+                    custo = custoAcao;
+                    encontrado = true;
+                    return;
+                }
+                buffer.push_back(codec.encode(valores));
+                if (buffer.size() == buffer_expansao) grava_run(buffer, runs);
+            });
+        }
+        if (leitor.falha()) return erro();
+        if (!encontrado && !buffer.empty()) grava_run(buffer, runs);
+        return encontrado;
+    }
+
+    // Merges `entradas` into one sorted, duplicate-free run
+    bool junta(const std::vector<std::string>& entradas, const std::string& saida) {
+        std::vector<std::unique_ptr<LeitorRun> > leitores;
+        typedef std::pair<PackedState, size_t> Item;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item> > heap;
+        for (size_t r = 0; r < entradas.size(); ++r) {
+            leitores.push_back(std::unique_ptr<LeitorRun>(new LeitorRun(entradas[r], buffer_leitura)));
+            if (!leitores[r]->ok()) return erro();
+            PackedState chave;
+            if (leitores[r]->proximo(chave)) heap.push(Item(chave, r));
+        }
+
+        EscritorRun escritor(saida, buffer_leitura);
+        bool primeiro = true;
+        PackedState ultimo;
+        while (!heap.empty()) {
+            Item topo = heap.top();
+            heap.pop();
+            if (primeiro || topo.first != ultimo) escritor.escreve(topo.first);
+            else medidas.duplicado();
+            ultimo = topo.first;
+            primeiro = false;
+            PackedState chave;
+            if (leitores[topo.second]->proximo(chave)) heap.push(Item(chave, topo.second));
+        }
+        for (size_t r = 0; r < leitores.size(); ++r) {
+            if (leitores[r]->falha()) return erro();
+        }
+        return escritor.fecha() || erro();
+    }
+
+    // Reduces the runs to one file, merging at most kMaxFanIn at a time
+    bool reduz(std::vector<std::string>& runs) {
+        while (runs.size() > 1) {
+            std::vector<std::string> maiores;
+            for (size_t i = 0; i < runs.size(); i += kMaxFanIn) {
+                std::vector<std::string> grupo(runs.begin() + i, runs.begin() + std::min(runs.size(), i + kMaxFanIn));
+                maiores.push_back(novo_arquivo());
+                bool ok = junta(grupo, maiores.back());
+                for (size_t g = 0; g < grupo.size(); ++g) std::remove(grupo[g].c_str());
+                if (!ok) return false;
+            }
+            runs.swap(maiores);
+        }
+        return true;
+    }
+
+    // Joins the children with the visited file: new states form the next
+    // layer, and the visited file is rewritten to include them. Returns
+    // false when the layer comes out empty (search exhausted) or on error.
+    bool proxima_camada(std::vector<std::string>& runs) {
+        if (runs.empty()) return false;
+        if (!reduz(runs)) return false;
+
+        std::string nova_camada = novo_arquivo();
+        std::string novos_visitados = novo_arquivo();
+        size_t novos = 0;
+        {
+            LeitorRun filhos(runs[0], buffer_leitura);
+            LeitorRun vistos(visitados, buffer_leitura);
+            EscritorRun camada(nova_camada, buffer_leitura);
+            EscritorRun uniao(novos_visitados, buffer_leitura);
+            if (!filhos.ok() || !vistos.ok()) return erro();
+
+            PackedState f, v;
+            bool temF = filhos.proximo(f);
+            bool temV = vistos.proximo(v);
+            while (temF || temV) {
+                if (temV && (!temF || v < f)) {
+                    uniao.escreve(v);
+                    temV = vistos.proximo(v);
+                } else if (temV && v == f) {
+                    medidas.duplicado();
+                    uniao.escreve(v);
+                    temV = vistos.proximo(v);
+                    temF = filhos.proximo(f);
+                } else {
+                    camada.escreve(f);
+                    uniao.escreve(f);
+                    temF = filhos.proximo(f);
+                }
+            }
+            novos = camada.total();
+            if (filhos.falha() || vistos.falha()) return erro();
+            if (!camada.fecha() || !uniao.fecha()) return erro();
+        }
+        std::remove(runs[0].c_str());
+        std::remove(visitados.c_str());
+        visitados = novos_visitados;
+
+        if (novos == 0) {
+            std::remove(nova_camada.c_str());
+            return false;
+        }
+        camadas.push_back(nova_camada);
+        total_estados += novos;
+        tamanho_camada = novos;
+        medidas.guardou(novos);
+        medidas.abertos(novos);
+        medidas.fechados(total_estados);
+        return true;
+    }
+
+    // Finds a state of `camada` with `alvo` among its children
+    bool predecessor(const std::string& camada, const PackedState& alvo, PackedState& anterior, int& custo) {
+        LeitorRun leitor(camada, buffer_leitura);
+        if (!leitor.ok()) return false;
+        typename Kernel::State atual = kernel.make_state();
+        typename Kernel::State filho = kernel.make_state();
+        PackedState chave;
+        bool achou = false;
+        while (!achou && leitor.proximo(chave)) {
+            codec.decode(chave, atual.data());
+            kernel.for_each_successor(atual.data(), filho.data(), [&](const uint16_t* valores, int custoAcao, int, int) {
+                if (achou || codec.encode(valores) != alvo) return;
+                anterior = chave;
+                custo = custoAcao;
+                achou = true;
+            });
+        }
+        return achou && !leitor.falha();
+    }
+};
+
+struct LarguraExternaRunner {
+    NodeArena& nodes;
+    MedidasBusca& medidas;
+    SearchProgress& progresso;
+    SearchTrace* trace;
+    const StateCodec& codec;
+    const std::string& dir;
+    size_t orcamento;
+    bool encontrado;
+    bool falhou;
+    size_t estados;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        LarguraExterna<Kernel> busca(kernel, medidas, progresso, trace, codec, dir, orcamento);
+        encontrado = busca.run(nodes);
+        falhou = busca.falha();
+        estados = busca.estados();
+    }
+};
+
+void SearchAlgorithms::busca_largura_externa(const std::vector<Jar> &initial_jars, const std::string &dir, size_t ram_budget) {
+    begin_search();
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instância não suportada pelos kernels de busca.\n";
+        return;
+    }
+
+    // Private directory for this search's layer and run files
+    std::string modelo = (dir.empty() ? std::string(".") : dir) + "/water_jug_bfs_XXXXXX";
+    std::vector<char> caminho(modelo.begin(), modelo.end());
+    caminho.push_back('\0');
+    if (!mkdtemp(caminho.data())) {
+        if (verbose) std::cout << "Não foi possível criar o diretório temporário em " << dir << "\n";
+        return;
+    }
+    std::string diretorio(caminho.data());
+
+    nodes.reset(initial_jars);
+    LarguraExternaRunner runner = {nodes, medidas, progress, trace, codec, diretorio, ram_budget, false, false, 0};
+    with_jar_kernel(initial_jars, runner);
+    rmdir(diretorio.c_str());
+    record_goal(runner.encontrado ? nodes.size() - 1 : -1); // the arena holds just the path
+
+    if (runner.falhou) {
+        if (verbose) std::cout << "Erro de E/S na busca em largura externa (" << diretorio << ").\n";
+    } else if (!runner.encontrado) {
+        if (verbose) std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << runner.estados << "\n";
+    }
+}
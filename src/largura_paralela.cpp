@@ -0,0 +1,260 @@
+#include "executor.hpp"
+#include "flat_state_table.hpp"
+#include "jar_kernel.hpp"
+#include "search_trace.hpp"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Runs fn(0..workers-1), worker 0 on the calling thread
+template <class F>
+void run_workers(int workers, F& fn) {
+    std::vector<std::thread> threads;
+    threads.reserve(workers > 0 ? workers - 1 : 0);
+    for (int t = 1; t < workers; ++t) threads.push_back(std::thread(std::ref(fn), t));
+    fn(0);
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+}
+
+// Level-synchronous BFS. Every layer is a contiguous index range of the arena
+// and goes through three phases:
+//   1. expand: chunks of the layer are expanded in parallel, children already
+//      seen in earlier layers are filtered out (the visited shards are read-only here)
+//   2. dedup: each worker owns one shard of the visited set and claims the
+//      children hashed to it, walking chunks in layer order so that the first
+//      occurrence wins, exactly as in the serial search
+//   3. append: accepted children are added to the arena in layer order
+// Node numbering, parents and the goal found are identical to busca_largura.
+template <class Kernel>
+class LarguraParalela {
+public:
+    LarguraParalela(const Kernel& k, NodeArena& n, MedidasBusca& m, SearchProgress& p, SearchTrace* t, const StateCodec& c, int threads)
+        : kernel(k), nodes(n), medidas(m), progress(p), trace(t), codec(c), workers(std::max(1, threads)), shards(workers), shard_duplicates(workers) {
+        for (int s = 0; s < workers; ++s) shards[s].reserve(table_estimate(codec) / workers);
+    }
+
+    // Returns the goal node index, or -1
+    int run() {
+        typename Kernel::State initial = kernel.initial_state();
+        nodes.add(initial.data(), -1, 0, 0);
+        medidas.guardou();
+        shard_of(codec.encode(initial.data())).insert(codec.encode(initial.data()), 0);
+
+        int begin = 0;
+        int depth = 0;
+        TraceLayers layers(trace, "bfs layer", "depth");
+        while (begin < nodes.size()) {
+            int end = nodes.size();
+            medidas.abertos(end - begin);
+            layers.next(depth);
+            progress.set_bound(depth);
+            progress.set_frontier(end - begin);
+            int goal = expand_layer(begin, end, depth + 1);
+            progress.add_expansions(end - begin);
+            int last = goal == INT_MAX ? end : goal + 1;
+            for (int i = begin; i < last; ++i) {
+                nodes.set_closed(i);
+                nodes.set_visited(i);
+            }
+            if (goal != INT_MAX) return goal;
+            begin = end;
+            ++depth;
+        }
+        return -1;
+    }
+
+private:
+    static const int kMinParallelLayer = 2048; // smaller layers are expanded on one thread
+
+    struct Chunk {
+        int lo;
+        int hi;
+        int first_goal;
+        uint64_t expanded; // counters of this chunk, summed after the phase
+        uint64_t generated;
+        uint64_t duplicates;
+        std::vector<PackedState> keys;
+        std::vector<int> parents;
+        std::vector<int> g_costs;
+        std::vector<uint16_t> values;
+        std::vector<uint8_t> accepted;
+        std::vector<std::vector<int> > by_shard; // candidate positions per shard, in layer order
+    };
+
+    const Kernel& kernel;
+    NodeArena& nodes;
+    MedidasBusca& medidas;
+    SearchProgress& progress;
+    SearchTrace* trace;
+    const StateCodec& codec;
+    int workers;
+    std::vector<FlatStateTable<int> > shards; // visited set, value = depth
+    std::vector<uint64_t> shard_duplicates;   // per shard, written by its dedup worker
+    std::vector<Chunk> chunks;
+
+    int shard_index(const PackedState& key) const {
+        // High hash bits, the tables index their slots with the low ones
+        return static_cast<int>((PackedStateHash()(key) >> 40) % static_cast<size_t>(workers));
+    }
+    FlatStateTable<int>& shard_of(const PackedState& key) { return shards[shard_index(key)]; }
+
+    void expand_chunk(Chunk& chunk) {
+        const int n = kernel.num_jars();
+        typename Kernel::State current = kernel.make_state();
+        typename Kernel::State scratch = kernel.make_state();
+
+        chunk.first_goal = INT_MAX;
+        chunk.expanded = 0;
+        chunk.generated = 0;
+        chunk.duplicates = 0;
+        chunk.keys.clear();
+        chunk.parents.clear();
+        chunk.g_costs.clear();
+        chunk.values.clear();
+        chunk.by_shard.resize(workers);
+        for (int s = 0; s < workers; ++s) chunk.by_shard[s].clear();
+
+        for (int i = chunk.lo; i < chunk.hi; ++i) {
+            nodes.load_values(i, current.data());
+            if (kernel.is_goal(current.data())) {
+                chunk.first_goal = i; // the serial search stops here
+                break;
+            }
+            int g = nodes.g_cost(i);
+            if (MedidasBusca::kAtivas) ++chunk.expanded;
+            kernel.for_each_successor(current.data(), scratch.data(), [&](const uint16_t* child, int cost, int, int) {
+                if (MedidasBusca::kAtivas) ++chunk.generated;
+                PackedState key = codec.encode(child);
+                int s = shard_index(key);
+                if (shards[s].contains(key)) {
+                    if (MedidasBusca::kAtivas) ++chunk.duplicates;
+                    return;
+                }
+                chunk.by_shard[s].push_back(static_cast<int>(chunk.keys.size()));
+                chunk.keys.push_back(key);
+                chunk.parents.push_back(i);
+                chunk.g_costs.push_back(g + cost);
+                chunk.values.insert(chunk.values.end(), child, child + n);
+            });
+        }
+        chunk.accepted.assign(chunk.keys.size(), 0);
+    }
+
+    struct ExpandPhase {
+        LarguraParalela* self;
+        int used_chunks;
+        void operator()(int t) {
+            for (int c = t; c < used_chunks; c += self->workers) self->expand_chunk(self->chunks[c]);
+        }
+    };
+
+    struct DedupPhase {
+        LarguraParalela* self;
+        int used_chunks;
+        int depth;
+        void operator()(int s) {
+            FlatStateTable<int>& table = self->shards[s];
+            for (int c = 0; c < used_chunks; ++c) {
+                Chunk& chunk = self->chunks[c];
+                const std::vector<int>& mine = chunk.by_shard[s];
+                for (size_t k = 0; k < mine.size(); ++k) {
+                    chunk.accepted[mine[k]] = table.insert(chunk.keys[mine[k]], depth);
+                    if (MedidasBusca::kAtivas && !chunk.accepted[mine[k]]) ++self->shard_duplicates[s];
+                }
+            }
+        }
+    };
+
+    // Returns the index of the first goal of the layer, or INT_MAX
+    int expand_layer(int begin, int end, int depth) {
+        int size = end - begin;
+        int parallel = size >= kMinParallelLayer ? workers : 1;
+        int used_chunks = parallel;
+        if (static_cast<int>(chunks.size()) < used_chunks) chunks.resize(used_chunks);
+        for (int c = 0; c < used_chunks; ++c) {
+            chunks[c].lo = begin + static_cast<int>(static_cast<long long>(size) * c / used_chunks);
+            chunks[c].hi = begin + static_cast<int>(static_cast<long long>(size) * (c + 1) / used_chunks);
+        }
+
+        ExpandPhase expand = {this, used_chunks};
+        run_workers(parallel, expand);
+
+        // Children of nodes past the first goal are never generated by the serial search
+        int goal = INT_MAX;
+        for (int c = 0; c < used_chunks; ++c) {
+            if (chunks[c].first_goal != INT_MAX) {
+                goal = chunks[c].first_goal;
+                used_chunks = c + 1;
+                break;
+            }
+        }
+
+        DedupPhase dedup = {this, used_chunks, depth};
+        if (parallel > 1) {
+            run_workers(workers, dedup);
+        } else {
+            for (int s = 0; s < workers; ++s) dedup(s);
+        }
+
+        const int n = kernel.num_jars();
+        int before = nodes.size();
+        for (int c = 0; c < used_chunks; ++c) {
+            const Chunk& chunk = chunks[c];
+            for (size_t k = 0; k < chunk.keys.size(); ++k) {
+                if (chunk.accepted[k]) {
+                    nodes.add(&chunk.values[k * n], chunk.parents[k], chunk.g_costs[k], chunk.g_costs[k]);
+                }
+            }
+        }
+        if (MedidasBusca::kAtivas) {
+            for (int c = 0; c < used_chunks; ++c) {
+                medidas.nosExpandidos += chunks[c].expanded;
+                medidas.totalFilhosGerados += chunks[c].generated;
+                medidas.duplicados += chunks[c].duplicates;
+            }
+            for (int s = 0; s < workers; ++s) {
+                medidas.duplicados += shard_duplicates[s];
+                shard_duplicates[s] = 0;
+            }
+        }
+        medidas.guardou(nodes.size() - before);
+        medidas.fechados(nodes.size());
+        return goal;
+    }
+};
+
+struct LarguraParalelaRunner {
+    NodeArena& nodes;
+    MedidasBusca& medidas;
+    SearchProgress& progresso;
+    SearchTrace* trace;
+    const StateCodec& codec;
+    int threads;
+    int objetivo;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        LarguraParalela<Kernel> busca(kernel, nodes, medidas, progresso, trace, codec, threads);
+        objetivo = busca.run();
+    }
+};
+
+void SearchAlgorithms::busca_largura_paralela(const std::vector<Jar> &initial_jars, int threads) {
+    begin_search();
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instância não suportada pelos kernels de busca.\n";
+        return;
+    }
+
+    nodes.reset(initial_jars);
+    LarguraParalelaRunner runner = {nodes, medidas, progress, trace, codec, threads, -1};
+    with_jar_kernel(initial_jars, runner);
+    record_goal(runner.objetivo);
+
+    if (runner.objetivo == -1) {
+        if (verbose) std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << nodes.size() << "\n";
+    }
+}
@@ -2,11 +2,43 @@
 #include <vector>
 #include <ctime>
 #include <algorithm> // For std::min_element
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include "batch.hpp"
 #include "executor.hpp"
 #include "structure.hpp"
 
+// water_jug --batch [file] [--threads N] [--algorithm name]
+// Reads instances from `file` (stdin if omitted or "-"), see batch.hpp
+static int batch_main(int argc, char** argv) {
+    BatchOptions options;
+    std::string path = "-";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch") == 0) continue;
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) options.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--algorithm") == 0 && i + 1 < argc) options.algorithm = argv[++i];
+        else if (argv[i][0] != '-' || std::strcmp(argv[i], "-") == 0) path = argv[i];
+        else {
+            std::cerr << "usage: " << argv[0] << " --batch [file|-] [--threads N] [--algorithm name]\n";
+            return 2;
+        }
+    }
+
+    if (path == "-") return run_batch(options, std::cin, std::cout) ? 1 : 0;
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "cannot open " << path << "\n";
+        return 2;
+    }
+    return run_batch(options, in, std::cout) ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--batch") == 0) {
+        return batch_main(argc, argv);
+    }
 
-int main() {
     // Sample datasets
     std::vector<std::vector<Jar>> samples = {
         // Sample 1: 3 jars
@@ -37,7 +69,7 @@ int main() {
         time_taken = static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000;
         std::cout << "Time taken: " << time_taken << " ms\n";
         search.print(); // Clear states for next algorithm
-        search.states.clear(); // Clear states for next algorithm
+        search.release(); // Clear states for next algorithm
 
         // start = std::clock();
         // std::cout << "\nBusca Profundidade (depth limit 10):\n";
@@ -46,7 +78,7 @@ int main() {
         // time_taken = static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000;
         // std::cout << "Time taken: " << time_taken << " ms\n";
         // search.print(); // Clear states for next algorithm
-        // search.states.clear(); // Clear states for next algorithm
+        // search.release(); // Clear states for next algorithm
         
         start = std::clock();
         std::cout << "\nBusca Largura:\n";
@@ -55,7 +87,7 @@ int main() {
         time_taken = static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000;
         std::cout << "Time taken: " << time_taken << " ms\n";
         search.print(); // Clear states for next algorithm
-        search.states.clear(); // Clear states for next algorithm
+        search.release(); // Clear states for next algorithm
         
         start = std::clock();
         std::cout << "\nBusca Ordenada:\n";
@@ -64,7 +96,7 @@ int main() {
         time_taken = static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000;
         std::cout << "Time taken: " << time_taken << " ms\n";
         search.print(); // Clear states for next algorithm
-        search.states.clear(); // Clear states for next algorithm
+        search.release(); // Clear states for next algorithm
         
         start = std::clock();
         std::cout << "\nBusca Gulosa:\n";
@@ -73,7 +105,7 @@ int main() {
         time_taken = static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000;
         std::cout << "Time taken: " << time_taken << " ms\n";
         search.print(); // Clear states for next algorithm
-        search.states.clear(); // Clear states for next algorithm
+        search.release(); // Clear states for next algorithm
         
         start = std::clock();
         std::cout << "\nBusca A*:\n";
@@ -82,7 +114,7 @@ int main() {
         time_taken = static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000;
         std::cout << "Time taken: " << time_taken << " ms\n";
         search.print(); // Clear states for next algorithm
-        search.states.clear(); // Clear states for next algorithm
+        search.release(); // Clear states for next algorithm
         
         start = std::clock();
         std::cout << "\nBusca IDA*:\n";
@@ -91,7 +123,7 @@ int main() {
         time_taken = static_cast<double>(end - start) / CLOCKS_PER_SEC * 1000;
         std::cout << "Time taken: " << time_taken << " ms\n";
         search.print(); // Clear states for next algorithm
-        search.states.clear(); // Clear states for next algorithm
+        search.release(); // Clear states for next algorithm
     }
 
     return 0;
@@ -0,0 +1,166 @@
+#include "node_arena.hpp"
+#include <climits>
+
+NodeArena::NodeArena() : memory(nullptr), chunk_bytes(0), count(0), jars(0), width(1), target_Q(0) {}
+
+void NodeArena::use_memory(SearchMemory* m) {
+    blocks.clear();
+    chunks.clear();
+    count = 0;
+    memory = m;
+}
+
+void NodeArena::reset(const std::vector<Jar>& initial_jars) {
+    int max_cap = 0;
+    int min_cap = initial_jars.empty() ? 0 : INT_MAX;
+    for (const Jar& jar : initial_jars) {
+        max_cap = std::max(max_cap, jar.max_capacity);
+        min_cap = std::min(min_cap, jar.max_capacity);
+    }
+
+    int new_width = max_cap <= 0xFF ? 1 : (max_cap <= 0xFFFF ? 2 : 4);
+    size_t new_chunk_bytes = static_cast<size_t>(kChunkSize) *
+        (3 * sizeof(int32_t) + sizeof(uint8_t) + static_cast<size_t>(initial_jars.size()) * new_width);
+
+    // Chunks are only reusable when the node layout did not change; chunks in
+    // a SearchMemory belong to the search that allocated them
+    if (memory || new_chunk_bytes != chunk_bytes) {
+        blocks.clear();
+        chunks.clear();
+    }
+
+    layout = initial_jars;
+    jars = static_cast<int>(initial_jars.size());
+    width = new_width;
+    target_Q = min_cap;
+    chunk_bytes = new_chunk_bytes;
+    count = 0;
+}
+
+void NodeArena::grow() {
+    unsigned char* p;
+    if (memory) {
+        p = static_cast<unsigned char*>(memory->allocate(chunk_bytes));
+    } else {
+        blocks.push_back(std::unique_ptr<unsigned char[]>(new unsigned char[chunk_bytes]));
+        p = blocks.back().get();
+    }
+    Chunk c;
+    c.parent = reinterpret_cast<int32_t*>(p);
+    c.g_cost = c.parent + kChunkSize;
+    c.f_cost = c.g_cost + kChunkSize;
+    c.values = reinterpret_cast<unsigned char*>(c.f_cost + kChunkSize);
+    c.flags = reinterpret_cast<uint8_t*>(c.values + static_cast<size_t>(kChunkSize) * jars * width);
+    chunks.push_back(c);
+}
+
+void NodeArena::set_value(int i, int jar, int v) {
+    Chunk& c = chunk(i);
+    size_t pos = static_cast<size_t>(offset(i)) * jars + jar;
+    switch (width) {
+        case 1: c.values[pos] = static_cast<uint8_t>(v); break;
+        case 2: reinterpret_cast<uint16_t*>(c.values)[pos] = static_cast<uint16_t>(v); break;
+        default: reinterpret_cast<int32_t*>(c.values)[pos] = v; break;
+    }
+}
+
+int NodeArena::add(const GameState& state) {
+    if ((count >> kChunkShift) >= static_cast<int>(chunks.size())) grow();
+    int i = count++;
+    chunk(i).flags[offset(i)] = 0;
+    store(i, state);
+    return i;
+}
+
+int NodeArena::add(const uint16_t* values, int parent, int g_cost, int f_cost) {
+    if ((count >> kChunkShift) >= static_cast<int>(chunks.size())) grow();
+    int i = count++;
+    Chunk& c = chunk(i);
+    int o = offset(i);
+    size_t pos = static_cast<size_t>(o) * jars;
+    switch (width) {
+        case 1:
+            for (int j = 0; j < jars; ++j) c.values[pos + j] = static_cast<uint8_t>(values[j]);
+            break;
+        case 2:
+            for (int j = 0; j < jars; ++j) reinterpret_cast<uint16_t*>(c.values)[pos + j] = values[j];
+            break;
+        default:
+            for (int j = 0; j < jars; ++j) reinterpret_cast<int32_t*>(c.values)[pos + j] = values[j];
+            break;
+    }
+    c.parent[o] = parent;
+    c.g_cost[o] = g_cost;
+    c.f_cost[o] = f_cost;
+    c.flags[o] = 0;
+    return i;
+}
+
+void NodeArena::load_values(int i, uint16_t* out) const {
+    const Chunk& c = chunk(i);
+    size_t pos = static_cast<size_t>(offset(i)) * jars;
+    switch (width) {
+        case 1:
+            for (int j = 0; j < jars; ++j) out[j] = c.values[pos + j];
+            break;
+        case 2:
+            for (int j = 0; j < jars; ++j) out[j] = reinterpret_cast<const uint16_t*>(c.values)[pos + j];
+            break;
+        default:
+            for (int j = 0; j < jars; ++j) out[j] = static_cast<uint16_t>(reinterpret_cast<const int32_t*>(c.values)[pos + j]);
+            break;
+    }
+}
+
+void NodeArena::store(int i, const GameState& state) {
+    for (int j = 0; j < jars; ++j) set_value(i, j, state.jars[j].current_value);
+    set_parent(i, state.parent);
+    set_g_cost(i, state.g_cost);
+    set_f_cost(i, state.f_cost);
+    set_visited(i, state.visited);
+    set_closed(i, state.closed);
+}
+
+void NodeArena::load(int i, GameState& state) const {
+    for (int j = 0; j < jars; ++j) {
+        int v = value(i, j);
+        state.jars[j].current_value = v;
+        state.values[j] = v;
+    }
+    state.parent = parent(i);
+    state.g_cost = g_cost(i);
+    state.f_cost = f_cost(i);
+    state.visited = visited(i);
+    state.closed = closed(i);
+    state.index = i;
+}
+
+bool NodeArena::same_values(int i, const std::vector<int>& values) const {
+    for (int j = 0; j < jars; ++j) {
+        if (value(i, j) != values[j]) return false;
+    }
+    return true;
+}
+
+bool NodeArena::same_values(int i, const uint16_t* values) const {
+    for (int j = 0; j < jars; ++j) {
+        if (value(i, j) != values[j]) return false;
+    }
+    return true;
+}
+
+bool NodeArena::is_goal(int i) const {
+    if (jars == 0) return false;
+    for (int j = 0; j < jars; ++j) {
+        if (value(i, j) != target_Q) return false;
+    }
+    return true;
+}
+
+std::string NodeArena::to_key(int i) const {
+    std::string key;
+    for (int j = 0; j < jars; ++j) {
+        key += std::to_string(value(i, j)) + "|";
+    }
+    return key;
+}
@@ -1,201 +1,253 @@
 #include "executor.hpp"
+#include "flat_state_table.hpp"
+#include "indexed_heap.hpp"
+#include "jar_kernel.hpp"
 #include <iostream>
 #include <vector>
-#include <algorithm>
-#include <deque>
-#include <set>
-
-enum Acao {
-    FILL,
-    EMPTY,
-    TRANSFER_LEFT,
-    TRANSFER_RIGHT
-};
-
-void copiaEstadoOG(const GameState &origem, GameState &destino) {
-    destino.jars = origem.jars;
-    destino.values = origem.values;
-    destino.g_cost = origem.g_cost;
-    destino.f_cost = origem.f_cost;
-    destino.parent = origem.parent;
-    destino.closed = false;
-    destino.visited = false;
-    destino.target_Q = origem.target_Q;
-    destino.max_cap = origem.max_cap;
-    destino.num_jars = origem.num_jars;
-}
 
-bool geraFilhoOG(Acao acao, GameState &state, int indiceJarra, GameState &newState, std::vector<GameState> &states) {
-    if (indiceJarra < 0 || indiceJarra >= state.num_jars) {
-        return false;
+// Orders node indices by path cost, older nodes first on ties
+struct ComparaPorCusto {
+    const NodeArena &nodes;
+    explicit ComparaPorCusto(const NodeArena &n) : nodes(n) {}
+    bool operator()(int a, int b) const {
+        if (nodes.g_cost(a) != nodes.g_cost(b)) return nodes.g_cost(a) < nodes.g_cost(b); // Menor custo primeiro
+        return a < b;
     }
+};
 
-    copiaEstadoOG(state, newState);
-    bool valid_action = false;
-    int action_cost = 0;
-
-    switch (acao) {
-    case FILL:
-        if (!state.jars[indiceJarra].is_full()) {
-            action_cost = state.jars[indiceJarra].space_left();
-            newState.jars[indiceJarra].fill();
-            valid_action = true;
-        }
-        break;
-    case EMPTY:
-        if (!state.jars[indiceJarra].is_empty()) {
-            action_cost = state.jars[indiceJarra].current_value;
-            newState.jars[indiceJarra].empty();
-            valid_action = true;
-        }
-        break;
-    case TRANSFER_LEFT:
-        if (indiceJarra > 0 && !state.jars[indiceJarra].is_empty() && !state.jars[indiceJarra - 1].is_full()) {
-            int transferred = state.get_transfer_value_from_jars(state.jars[indiceJarra], state.jars[indiceJarra - 1]);
-            action_cost = transferred;
-            newState.transfer_from_jars(newState.jars[indiceJarra], newState.jars[indiceJarra - 1]);
-            valid_action = true;
+// Uniform-cost search (Dijkstra): always expands the cheapest open node, so
+// the first goal taken out of the heap is a cheapest one. A cheaper path to a
+// state still open lowers its g in place (decrease-key); expanded states are
+// closed for good. Returns the goal node index, or -1.
+template <class Kernel>
+int busca_custo_uniforme_kernel(const Kernel& kernel, NodeArena& nodes, MedidasBusca& medidas, SearchProgress& progresso,
+                                const StateCodec& codec, SearchMemory& memoria) {
+    typename Kernel::State estadoAtual = kernel.initial_state();
+    typename Kernel::State filho = kernel.make_state();
+
+    nodes.add(estadoAtual.data(), -1, 0, 0); // f = g, sem heurística
+    medidas.guardou();
+
+    FlatStateTable<int> estados(table_estimate(codec), &memoria); // estado -> nó
+    estados.count_probes(MedidasBusca::kAtivas);
+    estados.insert(codec.encode(estadoAtual.data()), 0);
+
+    IndexedHeap<ComparaPorCusto> abertos(ComparaPorCusto(nodes), &memoria);
+    abertos.push(0);
+
+    int objetivo = -1;
+    uint64_t fechados = 0;
+    int custoMaximo = -1;
+    while (!abertos.empty()) {
+        medidas.abertos(abertos.size());
+        progresso.expanded(abertos.size());
+        int indiceAtual = abertos.pop();
+        nodes.set_visited(indiceAtual);
+        nodes.set_closed(indiceAtual);
+        ++fechados;
+        nodes.load_values(indiceAtual, estadoAtual.data());
+
+        int custo = nodes.g_cost(indiceAtual);
+        if (custo > custoMaximo) {
+            custoMaximo = custo;
+            progresso.set_bound(custo);
         }
-        break;
-    case TRANSFER_RIGHT:
-        if (indiceJarra < state.num_jars - 1 && !state.jars[indiceJarra].is_empty() && !state.jars[indiceJarra + 1].is_full()) {
-            int transferred = state.get_transfer_value_from_jars(state.jars[indiceJarra], state.jars[indiceJarra + 1]);
-            action_cost = transferred;
-            newState.transfer_from_jars(newState.jars[indiceJarra], newState.jars[indiceJarra + 1]);
-            valid_action = true;
+        if (kernel.is_goal(estadoAtual.data())) {
+            objetivo = indiceAtual;
+            break;
         }
-        break;
-    }
 
-    if (valid_action) {
-        newState.g_cost = state.g_cost + action_cost; // Explicitly set g_cost from parent
-        newState.f_cost = newState.g_cost + newState.heuristic();
-        // Sync values from updated jars
-        for (int i = 0; i < newState.num_jars; ++i) {
-            newState.values[i] = newState.jars[i].current_value;
-        }
-        newState.parent = state.index;
-        newState.index = states.size();
-        states.push_back(newState);
-        return true;
+        medidas.expandiu();
+        kernel.for_each_successor(estadoAtual.data(), filho.data(), [&](const uint16_t* valoresFilho, int custoAcao, int, int) {
+            medidas.gerou();
+            int g = custo + custoAcao;
+            PackedState chave = codec.encode(valoresFilho);
+            int* existente = estados.find(chave);
+            if (!existente) {
+                int novo = nodes.add(valoresFilho, indiceAtual, g, g);
+                estados.insert(chave, novo);
+                abertos.push(novo);
+                medidas.guardou();
+                return;
+            }
+            int outro = *existente;
+            if (nodes.closed(outro) || g >= nodes.g_cost(outro)) {
+                medidas.duplicado();
+                return;
+            }
+            nodes.set_g_cost(outro, g);
+            nodes.set_f_cost(outro, g);
+            nodes.set_parent(outro, indiceAtual);
+            abertos.update(outro);
+        });
     }
-    return false;
-}
-
-bool comparaPorCusto(const GameState &stateA, const GameState &stateB) {
-    return stateA.g_cost < stateB.g_cost; // Menor custo primeiro
-}
-
-bool comparaPorHeuristica(const GameState &stateA, const GameState &stateB) {
-    return stateA.heuristic() < stateB.heuristic(); // Menor heurística primeiro
+    medidas.fechados(fechados);
+    medidas.sondagens(estados.probe_lookups(), estados.probe_steps());
+    return objetivo;
 }
 
-void SearchAlgorithms::busca_ordenada(const std::vector<Jar> &initial_jars) {
-    states.clear();
-    GameState estadoInicial(initial_jars, -1);
-    estadoInicial.index = 0;
-    estadoInicial.g_cost = 0; // Initialize g_cost for initial state
-    states.push_back(estadoInicial);
-
-    std::set<std::string> jaVisitados;
-    jaVisitados.insert(estadoInicial.to_key());
-
-    std::deque<GameState> abertos;
-    abertos.push_back(estadoInicial);
+struct CustoUniformeRunner {
+    NodeArena& nodes;
+    MedidasBusca& medidas;
+    SearchProgress& progresso;
+    const StateCodec& codec;
+    SearchMemory& memoria;
+    int objetivo;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        objetivo = busca_custo_uniforme_kernel(kernel, nodes, medidas, progresso, codec, memoria);
+    }
+};
 
-    while (!abertos.empty()) {
-        GameState estadoAtual = abertos.front();
-        abertos.pop_front();
-        states[estadoAtual.index].visited = true;
-        states[estadoAtual.index].closed = true;
-
-        if (estadoAtual.is_goal()) {
-           
-            return;
+// Orders node indices by their cached heuristic, then by the tie-break rule
+struct ComparaPorHeuristica {
+    const ArenaVector<int> &h;
+    const NodeArena &nodes;
+    SearchAlgorithms::GreedyTieBreak desempate;
+    ComparaPorHeuristica(const ArenaVector<int> &heuristicas, const NodeArena &n, SearchAlgorithms::GreedyTieBreak d)
+        : h(heuristicas), nodes(n), desempate(d) {}
+    bool operator()(int a, int b) const {
+        if (h[a] != h[b]) return h[a] < h[b]; // Menor heurística primeiro
+        if (desempate == SearchAlgorithms::GREEDY_LOWEST_G && nodes.g_cost(a) != nodes.g_cost(b)) {
+            return nodes.g_cost(a) < nodes.g_cost(b);
         }
+        return desempate == SearchAlgorithms::GREEDY_OLDEST ? a < b : a > b;
+    }
+};
 
-        std::vector<GameState> filhosNovosOrdenados;
+// The reverse order, to find the node a full beam gives up
+struct ComparaPiorHeuristica {
+    ComparaPorHeuristica melhor;
+    explicit ComparaPiorHeuristica(const ComparaPorHeuristica &c) : melhor(c) {}
+    bool operator()(int a, int b) const { return melhor(b, a); }
+};
 
-        for (int numJarro = 0; numJarro < estadoAtual.num_jars; ++numJarro) {
-            GameState filhoFill;
-            if (geraFilhoOG(FILL, estadoAtual, numJarro, filhoFill, states) && jaVisitados.insert(filhoFill.to_key()).second) {
-                filhosNovosOrdenados.push_back(filhoFill);
-            }
-            GameState filhoEmpty;
-            if (geraFilhoOG(EMPTY, estadoAtual, numJarro, filhoEmpty, states) && jaVisitados.insert(filhoEmpty.to_key()).second) {
-                filhosNovosOrdenados.push_back(filhoEmpty);
+// Greedy best-first search: a global heap always expands the open node of
+// lowest h, computed once when the node is generated and kept in `h`. The
+// goal is tested on generation, since greedy makes no promise about cost.
+// With a beam width the frontier keeps only that many nodes, dropping the
+// worst one when a better child arrives; the search may then miss a solution.
+// Returns the goal node index, or -1.
+template <class Kernel>
+int busca_gulosa_kernel(const Kernel& kernel, NodeArena& nodes, MedidasBusca& medidas, SearchProgress& progresso,
+                        const StateCodec& codec, uint64_t limiteDenso, SearchMemory& memoria,
+                        SearchAlgorithms::GreedyTieBreak desempate, size_t larguraFeixe) {
+    typename Kernel::State estadoAtual = kernel.initial_state();
+    typename Kernel::State filho = kernel.make_state();
+
+    ArenaVector<int> h((ArenaAllocator<int>(&memoria))); // por nó
+    h.push_back(kernel.heuristic(estadoAtual.data()));
+    nodes.add(estadoAtual.data(), -1, 0, h[0]);
+    medidas.guardou();
+    if (kernel.is_goal(estadoAtual.data())) return 0;
+
+    VisitedStates jaVisitados(codec, limiteDenso, &memoria);
+    jaVisitados.count_probes(MedidasBusca::kAtivas);
+    jaVisitados.insert(codec.encode(estadoAtual.data()));
+
+    ComparaPorHeuristica compara(h, nodes, desempate);
+    IndexedHeap<ComparaPorHeuristica> abertos(compara, &memoria);
+    IndexedHeap<ComparaPiorHeuristica> piores(ComparaPiorHeuristica(compara), &memoria); // só com feixe
+    abertos.push(0);
+    if (larguraFeixe) piores.push(0);
+
+    int objetivo = -1;
+    uint64_t fechados = 0;
+    while (!abertos.empty() && objetivo == -1) {
+        medidas.abertos(abertos.size());
+        progresso.expanded(abertos.size());
+        int indiceAtual = abertos.pop();
+        if (larguraFeixe) piores.erase(indiceAtual);
+        nodes.set_visited(indiceAtual);
+        nodes.set_closed(indiceAtual);
+        ++fechados;
+        nodes.load_values(indiceAtual, estadoAtual.data());
+
+        medidas.expandiu();
+        int custo = nodes.g_cost(indiceAtual);
+        JarHeuristicTerms termos = kernel.heuristic_terms(estadoAtual.data());
+        kernel.for_each_successor(estadoAtual.data(), filho.data(), [&](const uint16_t* valoresFilho, int custoAcao, int jarra, int tipo) {
+            if (objetivo != -1) return;
+            medidas.gerou();
+            if (!jaVisitados.insert(codec.encode(valoresFilho))) {
+                medidas.duplicado();
+                return;
             }
-            GameState filhoTransferLeft;
-            if (geraFilhoOG(TRANSFER_LEFT, estadoAtual, numJarro, filhoTransferLeft, states) && jaVisitados.insert(filhoTransferLeft.to_key()).second) {
-                filhosNovosOrdenados.push_back(filhoTransferLeft);
+            int g = custo + custoAcao;
+            int hFilho = kernel.child_heuristic(termos, estadoAtual.data(), valoresFilho, jarra, tipo);
+            int novo = nodes.add(valoresFilho, indiceAtual, g, g + hFilho);
+            h.push_back(hFilho);
+            medidas.guardou();
+            if (kernel.is_goal(valoresFilho)) {
+                objetivo = novo;
+                return;
             }
-            GameState filhoTransferRight;
-            if (geraFilhoOG(TRANSFER_RIGHT, estadoAtual, numJarro, filhoTransferRight, states) && jaVisitados.insert(filhoTransferRight.to_key()).second) {
-                filhosNovosOrdenados.push_back(filhoTransferRight);
+            if (larguraFeixe && abertos.size() >= larguraFeixe) {
+                int pior = piores.top();
+                if (!compara(novo, pior)) return; // feixe cheio de nós melhores
+                abertos.erase(pior);
+                piores.erase(pior);
             }
-        }
-
-        std::sort(filhosNovosOrdenados.begin(), filhosNovosOrdenados.end(), comparaPorCusto);
-
-        for (auto it = filhosNovosOrdenados.rbegin(); it != filhosNovosOrdenados.rend(); ++it) {
-            abertos.push_front(*it);
-        }
+            abertos.push(novo);
+            if (larguraFeixe) piores.push(novo);
+        });
     }
-
-    std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << states.size() << "\n";
+    if (objetivo != -1) nodes.set_visited(objetivo);
+    medidas.fechados(fechados);
+    medidas.sondagens(jaVisitados.probe_lookups(), jaVisitados.probe_steps());
+    return objetivo;
 }
 
-void SearchAlgorithms::busca_gulosa(const std::vector<Jar> &initial_jars) {
-    states.clear();
-    GameState estadoInicial(initial_jars, -1);
-    estadoInicial.index = 0;
-    estadoInicial.g_cost = 0; // Initialize g_cost for initial state
-    states.push_back(estadoInicial);
-
-    std::set<std::string> jaVisitados;
-    jaVisitados.insert(estadoInicial.to_key());
+struct GulosaRunner {
+    NodeArena& nodes;
+    MedidasBusca& medidas;
+    SearchProgress& progresso;
+    const StateCodec& codec;
+    uint64_t limiteDenso;
+    SearchMemory& memoria;
+    SearchAlgorithms::GreedyTieBreak desempate;
+    size_t larguraFeixe;
+    int objetivo;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        objetivo = busca_gulosa_kernel(kernel, nodes, medidas, progresso, codec, limiteDenso, memoria, desempate, larguraFeixe);
+    }
+};
 
-    std::deque<GameState> abertos;
-    abertos.push_back(estadoInicial);
+void SearchAlgorithms::busca_ordenada(const std::vector<Jar> &initial_jars) {
+    begin_search();
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instância não suportada pelos kernels de busca.\n";
+        return;
+    }
 
-    while (!abertos.empty()) {
-        GameState estadoAtual = abertos.front();
-        abertos.pop_front();
-        states[estadoAtual.index].visited = true;
-        states[estadoAtual.index].closed = true;
-
-        if (estadoAtual.is_goal()) {
-         
-            return;
-        }
+    nodes.reset(initial_jars);
+    CustoUniformeRunner runner = {nodes, medidas, progress, codec, memory, -1};
+    with_jar_kernel(initial_jars, runner);
+    record_goal(runner.objetivo);
 
-        std::vector<GameState> filhosNovosOrdenados;
+    if (runner.objetivo == -1) {
+        if (verbose) std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << nodes.size() << "\n";
+    }
+}
 
-        for (int numJarro = 0; numJarro < estadoAtual.num_jars; ++numJarro) {
-            GameState filhoFill;
-            if (geraFilhoOG(FILL, estadoAtual, numJarro, filhoFill, states) && jaVisitados.insert(filhoFill.to_key()).second) {
-                filhosNovosOrdenados.push_back(filhoFill);
-            }
-            GameState filhoEmpty;
-            if (geraFilhoOG(EMPTY, estadoAtual, numJarro, filhoEmpty, states) && jaVisitados.insert(filhoEmpty.to_key()).second) {
-                filhosNovosOrdenados.push_back(filhoEmpty);
-            }
-            GameState filhoTransferLeft;
-            if (geraFilhoOG(TRANSFER_LEFT, estadoAtual, numJarro, filhoTransferLeft, states) && jaVisitados.insert(filhoTransferLeft.to_key()).second) {
-                filhosNovosOrdenados.push_back(filhoTransferLeft);
-            }
-            GameState filhoTransferRight;
-            if (geraFilhoOG(TRANSFER_RIGHT, estadoAtual, numJarro, filhoTransferRight, states) && jaVisitados.insert(filhoTransferRight.to_key()).second) {
-                filhosNovosOrdenados.push_back(filhoTransferRight);
-            }
-        }
+void SearchAlgorithms::busca_gulosa(const std::vector<Jar> &initial_jars) {
+    begin_search();
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instância não suportada pelos kernels de busca.\n";
+        return;
+    }
 
-        std::sort(filhosNovosOrdenados.begin(), filhosNovosOrdenados.end(), comparaPorHeuristica);
+    nodes.reset(initial_jars);
+    GulosaRunner runner = {nodes, medidas, progress, codec, dense_visited_limit, memory, greedy_tie_break, greedy_beam_width, -1};
+    with_jar_kernel(initial_jars, search_heuristic(initial_jars), runner);
+    record_goal(runner.objetivo);
 
-        for (auto it = filhosNovosOrdenados.rbegin(); it != filhosNovosOrdenados.rend(); ++it) {
-            abertos.push_front(*it);
-        }
+    if (runner.objetivo == -1) {
+        if (verbose) std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << nodes.size() << "\n";
     }
-
-    std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << states.size() << "\n";
-}
\ No newline at end of file
+}
@@ -0,0 +1,42 @@
+#include "packed_state.hpp"
+#include <limits>
+
+StateCodec::StateCodec() : total_states(1), is_valid(true), single_word(true) {}
+
+StateCodec::StateCodec(const std::vector<Jar>& jars) : total_states(1), is_valid(true), single_word(true) {
+    const uint64_t max_word = std::numeric_limits<uint64_t>::max();
+    uint64_t product[2] = {1, 1};
+    int current_word = 0;
+
+    stride.reserve(jars.size());
+    radix.reserve(jars.size());
+    word.reserve(jars.size());
+
+    for (const Jar& jar : jars) {
+        uint64_t r = static_cast<uint64_t>(jar.max_capacity) + 1;
+        total_states = (total_states > max_word / r) ? max_word : total_states * r;
+        // Move on to the high word once the low one would overflow
+        if (product[current_word] > max_word / r) {
+            if (current_word == 1) {
+                is_valid = false;
+                r = 1;
+            } else {
+                current_word = 1;
+                single_word = false;
+                if (product[current_word] > max_word / r) {
+                    is_valid = false;
+                    r = 1;
+                }
+            }
+        }
+        stride.push_back(product[current_word]);
+        radix.push_back(r);
+        word.push_back(static_cast<uint8_t>(current_word));
+        product[current_word] *= r;
+    }
+}
+
+void StateCodec::decode(const PackedState& key, std::vector<int>& values) const {
+    values.resize(stride.size());
+    decode(key, values.data());
+}
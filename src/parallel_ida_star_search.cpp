@@ -0,0 +1,227 @@
+#include "executor.hpp"
+#include "ida_path.hpp"
+#include "jar_kernel.hpp"
+#include "search_trace.hpp"
+#include "work_stealing_pool.hpp"
+#include <atomic>
+#include <climits>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Root of a work unit: the path from the initial state down to it
+struct IdaUnit {
+    std::vector<uint16_t> values; // depth * jars values
+    std::vector<int> g_costs;
+};
+
+// Parallel IDA*. Every iteration expands the tree breadth-first down to a
+// shallow depth until there are enough subtrees to keep all threads busy,
+// then searches the subtrees on a work-stealing pool. Workers lower a shared
+// atomic minimum for the next threshold and stop as soon as one of them finds
+// a goal: any goal within the threshold is optimal, since the previous
+// iteration proved that nothing cheaper than the threshold reaches the goal.
+template <class Kernel>
+class ParallelIdaStar {
+public:
+    ParallelIdaStar(const Kernel& k, const StateCodec& c, int threads)
+        : kernel(k), codec(c), n(k.num_jars()), pool(threads), next_threshold(INT_MAX), found(false) {
+        tables.resize(pool.size());
+        for (int w = 0; w < pool.size(); ++w) {
+            searchers.push_back(std::unique_ptr<IdaPath<Kernel> >(new IdaPath<Kernel>(kernel, codec)));
+            searchers[w]->set_transpositions(&tables[w], kMaxTranspositions);
+            tables[w].count_probes(MedidasBusca::kAtivas); // only worker w touches it
+        }
+    }
+
+    bool run(MedidasBusca& stats, SearchProgress& progress, SearchTrace* trace) {
+        for (size_t w = 0; w < searchers.size(); ++w) searchers[w]->set_progress(&progress);
+        TraceLayers iterations(trace, "ida iteration", "threshold");
+        typename Kernel::State initial = kernel.initial_state();
+        IdaUnit root;
+        root.values.assign(initial.begin(), initial.end());
+        root.g_costs.push_back(0);
+        if (kernel.is_goal(initial.data())) {
+            solution = root;
+            return true;
+        }
+
+        int threshold = kernel.heuristic(initial.data());
+        while (true) {
+            stats.iteracao();
+            iterations.next(threshold);
+            progress.set_bound(threshold);
+            next_threshold.store(INT_MAX);
+            split(root, threshold, progress);
+            if (found.load()) break;
+
+            for (size_t t = 0; t < tables.size(); ++t) tables[t].clear();
+            for (size_t u = 0; u < units.size(); ++u) {
+                const IdaUnit* unit = &units[u];
+                pool.submit([this, unit, threshold](int w) { search_unit(w, *unit, threshold); });
+            }
+            pool.wait();
+            if (found.load()) break;
+
+            int next = next_threshold.load();
+            if (next == INT_MAX) break; // every path was explored
+            threshold = next;
+        }
+
+        stats.somar(split_stats);
+        for (size_t w = 0; w < searchers.size(); ++w) {
+            searchers[w]->finish_progress();
+            stats.somar(searchers[w]->stats);
+            stats.sondagens(tables[w].probe_lookups(), tables[w].probe_steps());
+        }
+        return found.load();
+    }
+
+    // Writes the solution path (root .. goal) into the arena
+    void store_path(NodeArena& nodes) const {
+        int depth = static_cast<int>(solution.g_costs.size());
+        for (int d = 0; d < depth; ++d) {
+            const uint16_t* v = &solution.values[d * n];
+            int idx = nodes.add(v, d - 1, solution.g_costs[d], solution.g_costs[d] + kernel.heuristic(v));
+            nodes.set_visited(idx);
+            if (d + 1 < depth) nodes.set_closed(idx);
+        }
+    }
+
+private:
+    static const int kUnitsPerThread = 16; // subtrees per worker, for load balance
+    static const int kMaxSplitDepth = 8;
+    static const size_t kMaxTranspositions = 1 << 20; // states remembered per worker and iteration
+
+    const Kernel& kernel;
+    const StateCodec& codec;
+    int n;
+    WorkStealingPool pool;
+    std::vector<std::unique_ptr<IdaPath<Kernel> > > searchers; // one per pool worker
+    std::vector<FlatStateTable<int> > tables;                   // per-worker transpositions
+    std::vector<IdaUnit> units;
+    MedidasBusca split_stats; // expansions of split(), over every iteration
+    std::atomic<int> next_threshold;
+    std::atomic<bool> found;
+    std::mutex solution_mutex;
+    IdaUnit solution;
+
+    void lower_next(int f) {
+        int current = next_threshold.load();
+        while (f < current && !next_threshold.compare_exchange_weak(current, f)) {}
+    }
+
+    bool on_path(const IdaUnit& unit, const uint16_t* v) const {
+        for (size_t d = 0; d < unit.g_costs.size(); ++d) {
+            bool same = true;
+            for (int j = 0; j < n && same; ++j) same = unit.values[d * n + j] == v[j];
+            if (same) return true;
+        }
+        return false;
+    }
+
+    // Fills `units` with the subtree roots for this threshold
+    void split(const IdaUnit& root, int threshold, SearchProgress& progress) {
+        units.assign(1, root);
+        std::vector<IdaUnit> deeper;
+        typename Kernel::State scratch = kernel.make_state();
+        int target_units = pool.size() * kUnitsPerThread;
+
+        uint64_t expanded = 0;
+        for (int depth = 0; depth < kMaxSplitDepth && static_cast<int>(units.size()) < target_units; ++depth) {
+            deeper.clear();
+            for (size_t u = 0; u < units.size() && !found.load(); ++u) {
+                const IdaUnit& unit = units[u];
+                const uint16_t* last = &unit.values[unit.values.size() - n];
+                int g = unit.g_costs.back();
+                JarHeuristicTerms terms = kernel.heuristic_terms(last);
+                split_stats.expandiu();
+                ++expanded;
+                kernel.for_each_successor(last, scratch.data(), [&](const uint16_t* child, int cost, int jar, int type) {
+                    if (found.load()) return;
+                    split_stats.gerou();
+                    int f = g + cost + kernel.child_heuristic(terms, last, child, jar, type);
+                    if (f > threshold) {
+                        lower_next(f);
+                        return;
+                    }
+                    if (on_path(unit, child)) {
+                        split_stats.duplicado();
+                        return;
+                    }
+                    deeper.push_back(unit);
+                    IdaUnit& extended = deeper.back();
+                    extended.values.insert(extended.values.end(), child, child + n);
+                    extended.g_costs.push_back(g + cost);
+                    if (kernel.is_goal(child)) {
+                        solution = extended;
+                        found.store(true);
+                    }
+                });
+            }
+            units.swap(deeper);
+            if (found.load() || units.empty()) break;
+        }
+        progress.add_expansions(expanded);
+    }
+
+    void search_unit(int w, const IdaUnit& unit, int threshold) {
+        if (found.load(std::memory_order_relaxed)) return;
+        IdaPath<Kernel>& searcher = *searchers[w];
+        searcher.start(unit.values.data(), unit.g_costs.data(), static_cast<int>(unit.g_costs.size()));
+        int next;
+        typename IdaPath<Kernel>::Result result = searcher.search(threshold, next, &found);
+        if (result == IdaPath<Kernel>::EXHAUSTED) {
+            lower_next(next);
+        } else if (result == IdaPath<Kernel>::FOUND) {
+            std::lock_guard<std::mutex> lock(solution_mutex);
+            if (found.load()) return; // another worker got there first
+            solution.values.clear();
+            solution.g_costs.clear();
+            for (int d = 0; d < searcher.depth(); ++d) {
+                solution.values.insert(solution.values.end(), searcher.values(d), searcher.values(d) + n);
+                solution.g_costs.push_back(searcher.g_cost(d));
+            }
+            found.store(true);
+        }
+    }
+};
+
+struct ParallelIdaStarRunner {
+    NodeArena& nodes;
+    MedidasBusca& stats;
+    SearchProgress& progress;
+    SearchTrace* trace;
+    const StateCodec& codec;
+    int threads;
+    bool found;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        ParallelIdaStar<Kernel> search(kernel, codec, threads);
+        found = search.run(stats, progress, trace);
+        if (found) search.store_path(nodes);
+        stats.guardou(nodes.size());
+    }
+};
+
+void SearchAlgorithms::solve_with_parallel_ida_star(const std::vector<Jar>& initial_jars, int threads) {
+    begin_search();
+    if (initial_jars.empty()) return;
+
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instance not supported by the search kernels.\n";
+        return;
+    }
+
+    nodes.reset(initial_jars);
+    ParallelIdaStarRunner runner = {nodes, medidas, progress, trace, codec, threads, false};
+    with_jar_kernel(initial_jars, search_heuristic(initial_jars), runner);
+    record_goal(runner.found ? nodes.size() - 1 : -1);
+
+    if (!runner.found) {
+        if (verbose) std::cout << "No solution found.\n";
+    }
+}
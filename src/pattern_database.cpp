@@ -0,0 +1,246 @@
+#include "pattern_database.hpp"
+#include "jar_kernel.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// File layout: header, capacities (uint16 each), padding to 8 bytes,
+// entries (uint16 per abstract state, pattern after pattern)
+const char kMagic[8] = {'W', 'J', 'P', 'D', 'B', '0', '0', '1'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t jars;
+    uint32_t window;
+    uint32_t combine;
+    uint32_t patterns;
+    uint64_t pattern_limit;
+    uint64_t entries;
+};
+
+size_t entries_offset(size_t jars) {
+    size_t end = sizeof(FileHeader) + jars * sizeof(uint16_t);
+    return (end + 7) & ~static_cast<size_t>(7);
+}
+
+const uint32_t kInfinite = 0xFFFFFFFFu;
+
+} // namespace
+
+const int PatternDatabase::kMaxWindow;
+const uint16_t PatternDatabase::kUnreachable;
+
+PatternDatabase::PatternDatabase(const std::vector<Jar>& jars, int window, Combine combine, uint64_t pattern_limit)
+    : window_size(std::max(1, std::min(window, kMaxWindow))), combine_as(combine), limit(pattern_limit),
+      total_entries(0), dead_end(0), table(nullptr), mapping(nullptr), mapping_size(0) {
+    for (const Jar& jar : jars) caps.push_back(static_cast<uint16_t>(jar.max_capacity));
+}
+
+PatternDatabase::~PatternDatabase() {
+    if (mapping) munmap(mapping, mapping_size);
+}
+
+bool PatternDatabase::matches(const std::vector<Jar>& jars, int window, Combine combine, uint64_t pattern_limit) const {
+    if (std::max(1, std::min(window, kMaxWindow)) != window_size || combine != combine_as || pattern_limit != limit) return false;
+    if (jars.size() != caps.size()) return false;
+    for (size_t j = 0; j < jars.size(); ++j) {
+        if (jars[j].max_capacity != caps[j]) return false;
+    }
+    return true;
+}
+
+std::string PatternDatabase::file_name(const std::vector<Jar>& jars, int window, Combine combine) {
+    std::string name = "water_jug_pdb_w" + std::to_string(window) + (combine == ADDITIVE ? "_add" : "_max");
+    for (const Jar& jar : jars) name += "_" + std::to_string(jar.max_capacity);
+    return name + ".bin";
+}
+
+// Cuts the row into windows of up to window_size jars, closing a window
+// early when one more jar would take its abstract space past the limit
+bool PatternDatabase::plan() {
+    layout.clear();
+    total_entries = 0;
+    const int n = static_cast<int>(caps.size());
+    for (int j = 0; j < n;) {
+        Pattern p;
+        p.first = j;
+        p.count = 0;
+        p.offset = total_entries;
+        p.size = 1;
+        while (j < n && p.count < window_size && p.size * (caps[j] + 1) <= limit) {
+            p.stride[p.count++] = static_cast<uint32_t>(p.size);
+            p.size *= caps[j] + 1;
+            ++j;
+        }
+        if (p.count == 0) return false;
+        layout.push_back(p);
+        total_entries += p.size;
+    }
+    return true;
+}
+
+// Dijkstra (Dial's buckets) on the reversed abstract actions of one window,
+// like DistanceTable::build. Costs are in half units: 2 per unit of water
+// filled, emptied or poured inside the window, and per unit crossing an
+// edge 1 when ADDITIVE (the other half is the neighbour's) or 2 when MAXIMUM.
+// Predecessors through an open edge held t less (water came in) or t more.
+void PatternDatabase::solve(const Pattern& pattern, uint16_t* out) const {
+    const int count = pattern.count;
+    const uint16_t* cap = &caps[pattern.first];
+    const bool open_left = pattern.first > 0;
+    const bool open_right = pattern.first + count < static_cast<int>(caps.size());
+    const int edge_cost = combine_as == ADDITIVE ? 1 : 2;
+    const uint32_t* stride = pattern.stride;
+    int target = *std::min_element(caps.begin(), caps.end());
+    int max_cap = *std::max_element(cap, cap + count);
+
+    std::vector<uint32_t> dist(pattern.size, kInfinite);
+    std::vector<std::vector<uint64_t> > buckets(2 * max_cap + 1);
+    size_t open = 0;
+    uint64_t d = 0;
+    auto relax = [&](uint64_t p, int cost) {
+        uint64_t nd = d + cost;
+        if (nd >= dist[p]) return;
+        dist[p] = static_cast<uint32_t>(nd);
+        buckets[nd % buckets.size()].push_back(p);
+        ++open;
+    };
+    auto pour = [&](uint64_t r, const int* s, int src, int dst) {
+        if (s[src] != 0 && s[dst] != cap[dst]) return;
+        int max_moved = std::min(cap[src] - s[src], s[dst]);
+        for (int t = 1; t <= max_moved; ++t) relax(r + t * stride[src] - t * stride[dst], 2 * t);
+    };
+
+    uint64_t goal = 0;
+    for (int i = 0; i < count; ++i) goal += target * static_cast<uint64_t>(stride[i]);
+    dist[goal] = 0;
+    buckets[0].push_back(goal);
+    open = 1;
+
+    int s[kMaxWindow];
+    for (; open > 0; ++d) {
+        std::vector<uint64_t>& bucket = buckets[d % buckets.size()];
+        while (!bucket.empty()) {
+            uint64_t r = bucket.back();
+            bucket.pop_back();
+            --open;
+            if (dist[r] != d) continue; // stale entry
+            for (int i = 0; i < count; ++i) s[i] = static_cast<int>(r / stride[i] % (cap[i] + 1));
+
+            for (int i = 0; i < count; ++i) {
+                if (s[i] == 0) {
+                    for (int held = 1; held <= cap[i]; ++held) relax(r + held * stride[i], 2 * held);
+                }
+                if (s[i] == cap[i]) {
+                    for (int held = 0; held < cap[i]; ++held) relax(r - (cap[i] - held) * stride[i], 2 * (cap[i] - held));
+                }
+                if (i + 1 < count) {
+                    pour(r, s, i, i + 1);
+                    pour(r, s, i + 1, i);
+                }
+                if ((i == 0 && open_left) || (i == count - 1 && open_right)) {
+                    for (int t = 1; t <= s[i]; ++t) relax(r - t * stride[i], edge_cost * t);
+                    for (int t = 1; t <= cap[i] - s[i]; ++t) relax(r + t * stride[i], edge_cost * t);
+                }
+            }
+        }
+    }
+
+    for (uint64_t r = 0; r < pattern.size; ++r) {
+        out[r] = dist[r] == kInfinite ? kUnreachable : static_cast<uint16_t>(std::min<uint32_t>(dist[r], kUnreachable - 1));
+    }
+}
+
+void PatternDatabase::find_dead_end() {
+    int bound = 0;
+    for (size_t p = 0; p < layout.size(); ++p) {
+        int largest = 0;
+        for (uint64_t r = 0; r < layout[p].size; ++r) {
+            uint16_t e = table[layout[p].offset + r];
+            if (e != kUnreachable) largest = std::max(largest, static_cast<int>(e));
+        }
+        bound = combine_as == ADDITIVE ? bound + largest : std::max(bound, largest);
+    }
+    dead_end = bound / 2 + 1;
+}
+
+std::unique_ptr<PatternDatabase> PatternDatabase::build(const std::vector<Jar>& jars, int window, Combine combine,
+                                                        uint64_t pattern_limit) {
+    if (!kernel_supports(jars)) return nullptr;
+    std::unique_ptr<PatternDatabase> db(new PatternDatabase(jars, window, combine, pattern_limit));
+    if (!db->plan()) return nullptr;
+
+    db->own_table.resize(db->total_entries);
+    for (size_t p = 0; p < db->layout.size(); ++p) db->solve(db->layout[p], &db->own_table[db->layout[p].offset]);
+    db->table = db->own_table.data();
+    db->find_dead_end();
+    return db;
+}
+
+bool PatternDatabase::save(const std::string& path) const {
+    // Written under a temporary name and renamed, so readers never map a partial file
+    std::string tmp = path + ".tmp" + std::to_string(getpid());
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.jars = static_cast<uint32_t>(caps.size());
+    header.window = static_cast<uint32_t>(window_size);
+    header.combine = static_cast<uint32_t>(combine_as);
+    header.patterns = static_cast<uint32_t>(layout.size());
+    header.pattern_limit = limit;
+    header.entries = total_entries;
+    const char padding[8] = {0};
+    size_t pad = entries_offset(caps.size()) - sizeof(FileHeader) - caps.size() * sizeof(uint16_t);
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1
+        && std::fwrite(caps.data(), sizeof(uint16_t), caps.size(), f) == caps.size()
+        && std::fwrite(padding, 1, pad, f) == pad
+        && std::fwrite(table, sizeof(uint16_t), total_entries, f) == total_entries;
+    ok = (std::fclose(f) == 0) && ok;
+    if (ok) ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok) std::remove(tmp.c_str());
+    return ok;
+}
+
+std::unique_ptr<PatternDatabase> PatternDatabase::load(const std::string& path, const std::vector<Jar>& jars, int window,
+                                                       Combine combine, uint64_t pattern_limit) {
+    if (!kernel_supports(jars)) return nullptr;
+    std::unique_ptr<PatternDatabase> db(new PatternDatabase(jars, window, combine, pattern_limit));
+    if (!db->plan()) return nullptr;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat info;
+    void* base = MAP_FAILED;
+    size_t offset = entries_offset(jars.size());
+    size_t expected = offset + db->total_entries * sizeof(uint16_t);
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) == expected) {
+        base = mmap(nullptr, expected, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) return nullptr;
+    db->mapping = base;
+    db->mapping_size = expected;
+
+    const char* bytes = static_cast<const char*>(base);
+    FileHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.jars != jars.size()
+        || header.window != static_cast<uint32_t>(db->window_size) || header.combine != static_cast<uint32_t>(combine)
+        || header.patterns != db->layout.size() || header.pattern_limit != pattern_limit
+        || header.entries != db->total_entries) {
+        return nullptr;
+    }
+    if (std::memcmp(bytes + sizeof(header), db->caps.data(), jars.size() * sizeof(uint16_t)) != 0) return nullptr;
+
+    db->table = reinterpret_cast<const uint16_t*>(bytes + offset);
+    db->find_dead_end();
+    return db;
+}
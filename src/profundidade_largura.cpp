@@ -1,215 +1,200 @@
 #include "executor.hpp"
+#include "flat_state_table.hpp"
+#include "jar_kernel.hpp"
+#include "search_trace.hpp"
 #include <iostream>
 #include <vector>
 #include <algorithm>
-#include <queue>
 #include <ctime>
-#include <set>
-
-enum Acao {
-    FILL,
-    EMPTY,
-    TRANSFER_LEFT,
-    TRANSFER_RIGHT
-};
-
-void copiaEstadoPL(const GameState &origem, GameState &destino) {
-    destino.jars = origem.jars;
-    destino.values = origem.values;
-    destino.parent = origem.parent;
-    destino.closed = false;
-    destino.visited = false;
-    destino.g_cost = origem.g_cost;
-    destino.f_cost = origem.f_cost;
-    destino.index = origem.index;
-    destino.target_Q = origem.target_Q;
-    destino.max_cap = origem.max_cap;
-    destino.num_jars = origem.num_jars;
-}
-
-bool checkParentLoopPL(const GameState& child, const std::vector<GameState>& states) {
-    if (child.parent == -1) return false;
-
-    std::string child_key = child.to_key();
-    int ancestor_idx = child.parent;
 
+// 🧠 Evita ciclos na árvore (loop de volta para ancestral)
+bool checkParentLoopPL(const uint16_t* filho, int indicePai, const NodeArena& nodes) {
+    int ancestor_idx = indicePai;
     while (ancestor_idx != -1) {
-        if (states[ancestor_idx].to_key() == child_key) {
+        if (nodes.same_values(ancestor_idx, filho)) {
             return true;
         }
-        ancestor_idx = states[ancestor_idx].parent;
+        ancestor_idx = nodes.parent(ancestor_idx);
     }
     return false;
 }
 
-bool geraFilhoPL(Acao acao, GameState &state, int indiceJarra, GameState &newState, std::vector<GameState>& states) {
-    if (indiceJarra < 0 || indiceJarra >= state.num_jars) {
-        return false;
-    }
-
-    copiaEstadoPL(state, newState);
-    bool valid_action = false;
-    int action_cost = 0;
-
-    switch (acao) {
-    case FILL:
-        if (!state.jars[indiceJarra].is_full()) {
-            action_cost = state.jars[indiceJarra].space_left();
-            newState.jars[indiceJarra].fill();
-            valid_action = true;
-        }
-        break;
-    case EMPTY:
-        if (!state.jars[indiceJarra].is_empty()) {
-            action_cost = state.jars[indiceJarra].current_value;
-            newState.jars[indiceJarra].empty();
-            valid_action = true;
-        }
-        break;
-    case TRANSFER_LEFT:
-        if (indiceJarra > 0 && !state.jars[indiceJarra].is_empty() && !state.jars[indiceJarra - 1].is_full()) {
-            int transferred = state.get_transfer_value_from_jars(state.jars[indiceJarra], state.jars[indiceJarra - 1]);
-            action_cost = transferred;
-            newState.transfer_from_jars(newState.jars[indiceJarra], newState.jars[indiceJarra - 1]);
-            valid_action = true;
-        }
-        break;
-    case TRANSFER_RIGHT:
-        if (indiceJarra < state.num_jars - 1 && !state.jars[indiceJarra].is_empty() && !state.jars[indiceJarra + 1].is_full()) {
-            int transferred = state.get_transfer_value_from_jars(state.jars[indiceJarra], state.jars[indiceJarra + 1]);
-            action_cost = transferred;
-            newState.transfer_from_jars(newState.jars[indiceJarra], newState.jars[indiceJarra + 1]);
-            valid_action = true;
-        }
-        break;
-    }
-
-    if (valid_action) {
-        newState.g_cost = state.g_cost + action_cost;
-        newState.f_cost = newState.g_cost + newState.heuristic();
+template <class Kernel>
+struct BuscaProfundidade {
+    const Kernel& kernel;
+    NodeArena& nodes;
+    MedidasBusca& medidas;
+    SearchProgress& progresso;
+    int profundidadeLimite;
+    int objetivo; // -1 até encontrar
+
+    void visita(int indice, const uint16_t* valores, int profundidade) {
+        if (profundidade >= profundidadeLimite || objetivo != -1)
+            return;
 
-        for (int i = 0; i < newState.num_jars; ++i) {
-            newState.values[i] = newState.jars[i].current_value;
+        if (kernel.is_goal(valores)) {
+            objetivo = indice;
+            return;
         }
 
-        newState.parent = state.index;
-        newState.index = states.size();
-
-        // 🧠 Evita ciclos na árvore (loop de volta para ancestral)
-        if (checkParentLoopPL(newState, states)) {
-
-            return false;
-        }
+        nodes.set_visited(indice);
+        medidas.expandiu();
+        medidas.abertos(profundidade + 1); // a pilha de recursão é a fronteira
+        progresso.expanded(profundidade + 1);
+
+        typename Kernel::State filho = kernel.make_state();
+        int custo = nodes.g_cost(indice);
+        kernel.for_each_successor(valores, filho.data(), [&](const uint16_t* valoresFilho, int custoAcao, int, int) {
+            if (objetivo != -1) return;
+            medidas.gerou();
+            if (checkParentLoopPL(valoresFilho, indice, nodes)) {
+                medidas.duplicado();
+                return;
+            }
+            int g = custo + custoAcao;
+            int indiceFilho = nodes.add(valoresFilho, indice, g, g + kernel.heuristic(valoresFilho));
+            medidas.guardou();
+            visita(indiceFilho, valoresFilho, profundidade + 1);
+        });
 
-        states.push_back(newState);
-        return true;
+        nodes.set_closed(indice);
     }
-    return false;
-}
+};
 
-void busca_profundidade_aux(GameState &state, int &profundidade, const int &profundidadeLimite,
-                             bool &noEncontrado, std::vector<GameState>& states) {
-    if (profundidade >= profundidadeLimite || noEncontrado)
-        return;
+// Retorna o índice do nó objetivo, ou -1. Os nós entram na arena na ordem em
+// que a fila os receberia, então a fila de abertos é só um cursor sobre ela.
+// As camadas são faixas contíguas de índices: a camada seguinte começa no
+// primeiro nó criado pela atual.
+template <class Kernel>
+int busca_largura_kernel(const Kernel& kernel, NodeArena& nodes, MedidasBusca& medidas, SearchProgress& progresso,
+                         SearchTrace* trace, const StateCodec& codec, uint64_t limiteDenso, SearchMemory& memoria) {
+    typename Kernel::State estadoAtual = kernel.initial_state();
+    typename Kernel::State filho = kernel.make_state();
 
-    if (state.is_goal()) {
-        noEncontrado = true;
-        return;
-    }
+    nodes.add(estadoAtual.data(), -1, 0, 0);
+    medidas.guardou();
 
-    profundidade++;
-    state.visited = true;
+    VisitedStates jaVisitados(codec, limiteDenso, &memoria);
+    jaVisitados.count_probes(MedidasBusca::kAtivas);
+    jaVisitados.insert(codec.encode(estadoAtual.data()));
 
-    for (int numJarro = 0; numJarro < state.num_jars; ++numJarro) {
-        GameState filhoFill;
-        if (geraFilhoPL(FILL, state, numJarro, filhoFill, states)) {
-            busca_profundidade_aux(filhoFill, profundidade, profundidadeLimite, noEncontrado, states);
-            if (noEncontrado) return;
+    int objetivo = -1;
+    int profundidade = 0;
+    int fimCamada = 1;
+    TraceLayers camadas(trace, "bfs layer", "depth");
+    camadas.next(0);
+    progresso.set_bound(0);
+    for (int indiceAtual = 0; indiceAtual < nodes.size(); ++indiceAtual) {
+        size_t abertos = nodes.size() - indiceAtual;
+        medidas.abertos(abertos);
+        progresso.expanded(abertos);
+        if (indiceAtual >= fimCamada) {
+            fimCamada = nodes.size();
+            camadas.next(++profundidade);
+            progresso.set_bound(profundidade);
         }
 
-        GameState filhoEmpty;
-        if (geraFilhoPL(EMPTY, state, numJarro, filhoEmpty, states)) {
-            busca_profundidade_aux(filhoEmpty, profundidade, profundidadeLimite, noEncontrado, states);
-            if (noEncontrado) return;
-        }
+        nodes.set_closed(indiceAtual);
+        nodes.set_visited(indiceAtual);
+        nodes.load_values(indiceAtual, estadoAtual.data());
 
-        GameState filhoTransferLeft;
-        if (geraFilhoPL(TRANSFER_LEFT, state, numJarro, filhoTransferLeft, states)) {
-            busca_profundidade_aux(filhoTransferLeft, profundidade, profundidadeLimite, noEncontrado, states);
-            if (noEncontrado) return;
+        if (kernel.is_goal(estadoAtual.data())) {
+            objetivo = indiceAtual;
+            break;
         }
 
-        GameState filhoTransferRight;
-        if (geraFilhoPL(TRANSFER_RIGHT, state, numJarro, filhoTransferRight, states)) {
-            busca_profundidade_aux(filhoTransferRight, profundidade, profundidadeLimite, noEncontrado, states);
-            if (noEncontrado) return;
-        }
+        medidas.expandiu();
+        int custo = nodes.g_cost(indiceAtual);
+        kernel.for_each_successor(estadoAtual.data(), filho.data(), [&](const uint16_t* valoresFilho, int custoAcao, int, int) {
+            medidas.gerou();
+            if (!jaVisitados.insert(codec.encode(valoresFilho))) {
+                medidas.duplicado();
+                return;
+            }
+            int g = custo + custoAcao;
+            nodes.add(valoresFilho, indiceAtual, g, g);
+            medidas.guardou();
+        });
     }
-
-    state.closed = true;
-    profundidade--;
+    medidas.fechados(jaVisitados.size());
+    medidas.sondagens(jaVisitados.probe_lookups(), jaVisitados.probe_steps());
+    return objetivo;
 }
 
-void SearchAlgorithms::busca_profundidade(const std::vector<Jar> &initial_jars, const int &profundidadeLimite) {
-    states.clear();
-    GameState estadoInicial(initial_jars, -1);
-    estadoInicial.index = 0;
-    estadoInicial.g_cost = 0;
-    states.push_back(estadoInicial);
+struct ProfundidadeRunner {
+    NodeArena& nodes;
+    MedidasBusca& medidas;
+    SearchProgress& progresso;
+    int profundidadeLimite;
+    int objetivo;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        typename Kernel::State inicial = kernel.initial_state();
+        nodes.add(inicial.data(), -1, 0, kernel.heuristic(inicial.data()));
+        medidas.guardou();
+        BuscaProfundidade<Kernel> busca = {kernel, nodes, medidas, progresso, profundidadeLimite, -1};
+        busca.visita(0, inicial.data(), 0);
+        objetivo = busca.objetivo;
+    }
+};
 
-    int profundidade = 0;
-    bool noEncontrado = false;
+struct LarguraRunner {
+    NodeArena& nodes;
+    MedidasBusca& medidas;
+    SearchProgress& progresso;
+    SearchTrace* trace;
+    const StateCodec& codec;
+    uint64_t limiteDenso;
+    SearchMemory& memoria;
+    int objetivo;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        objetivo = busca_largura_kernel(kernel, nodes, medidas, progresso, trace, codec, limiteDenso, memoria);
+    }
+};
 
-    busca_profundidade_aux(estadoInicial, profundidade, profundidadeLimite, noEncontrado, states);
+void SearchAlgorithms::busca_profundidade(const std::vector<Jar> &initial_jars, const int &profundidadeLimite) {
+    begin_search();
+    if (!kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instância não suportada pelos kernels de busca.\n";
+        return;
+    }
+
+    nodes.reset(initial_jars);
+    ProfundidadeRunner runner = {nodes, medidas, progress, profundidadeLimite, -1};
+    with_jar_kernel(initial_jars, runner);
+    record_goal(runner.objetivo);
 
-    if (!noEncontrado) {
-        std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << states.size() << "\n";
+    if (runner.objetivo == -1) {
+        if (verbose) std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << nodes.size() << "\n";
     }
 }
 
 void SearchAlgorithms::busca_largura(const std::vector<Jar> &initial_jars) {
-    states.clear();
-    GameState estadoInicial(initial_jars, -1);
-    estadoInicial.index = 0;
-    estadoInicial.g_cost = 0;
-    states.push_back(estadoInicial);
-
-    std::set<std::string> jaVisitados;
-    jaVisitados.insert(estadoInicial.to_key());
-
-    std::queue<GameState> abertos;
-    abertos.push(estadoInicial);
-
-    while (!abertos.empty()) {
-        GameState estadoAtual = abertos.front();
-        abertos.pop();
+    begin_search();
+    if (bfs_ram_budget > 0) {
+        busca_largura_externa(initial_jars, bfs_spill_dir, bfs_ram_budget);
+        return;
+    }
+    if (bfs_threads > 1) {
+        busca_largura_paralela(initial_jars, bfs_threads);
+        return;
+    }
 
-        states[estadoAtual.index].closed = true;
-        states[estadoAtual.index].visited = true;
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instância não suportada pelos kernels de busca.\n";
+        return;
+    }
 
-        if (estadoAtual.is_goal()) {
-            return;
-        }
+    nodes.reset(initial_jars);
+    LarguraRunner runner = {nodes, medidas, progress, trace, codec, dense_visited_limit, memory, -1};
+    with_jar_kernel(initial_jars, runner);
+    record_goal(runner.objetivo);
 
-        for (int numJarro = 0; numJarro < estadoAtual.num_jars; ++numJarro) {
-            GameState filhoFill;
-            if (geraFilhoPL(FILL, estadoAtual, numJarro, filhoFill, states) && jaVisitados.insert(filhoFill.to_key()).second) {
-                abertos.push(filhoFill);
-            }
-            GameState filhoEmpty;
-            if (geraFilhoPL(EMPTY, estadoAtual, numJarro, filhoEmpty, states) && jaVisitados.insert(filhoEmpty.to_key()).second) {
-                abertos.push(filhoEmpty);
-            }
-            GameState filhoTransferLeft;
-            if (geraFilhoPL(TRANSFER_LEFT, estadoAtual, numJarro, filhoTransferLeft, states) && jaVisitados.insert(filhoTransferLeft.to_key()).second) {
-                abertos.push(filhoTransferLeft);
-            }
-            GameState filhoTransferRight;
-            if (geraFilhoPL(TRANSFER_RIGHT, estadoAtual, numJarro, filhoTransferRight, states) && jaVisitados.insert(filhoTransferRight.to_key()).second) {
-                abertos.push(filhoTransferRight);
-            }
-        }
+    if (runner.objetivo == -1) {
+        if (verbose) std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << nodes.size() << "\n";
     }
-
-    std::cout << "Nenhuma solução encontrada. Total de estados explorados: " << states.size() << "\n";
 }
@@ -0,0 +1,31 @@
+#include "search_memory.hpp"
+#include <algorithm>
+
+const size_t SearchMemory::kFirstBlock;
+const size_t SearchMemory::kLargestBlock;
+const size_t SearchMemory::kAlign;
+
+uint64_t SearchMemory::bytes_reserved() const {
+    uint64_t total = 0;
+    for (size_t b = 0; b < blocks.size(); ++b) total += blocks[b].size;
+    return total;
+}
+
+// The current block is full: moves on to the next kept block that fits, or
+// appends one as large as everything reserved so far (capped), doubling it.
+// Kept blocks too small for the request sit idle until the next release.
+void* SearchMemory::allocate_slow(size_t bytes) {
+    size_t next = blocks.empty() ? 0 : current + 1;
+    while (next < blocks.size() && blocks[next].size < bytes) ++next;
+    if (next == blocks.size()) {
+        size_t size = std::min(std::max(static_cast<size_t>(bytes_reserved()), kFirstBlock), kLargestBlock);
+        Block block;
+        block.size = std::max(size, bytes);
+        block.data.reset(new unsigned char[block.size]);
+        blocks.push_back(std::move(block));
+    }
+    current = next;
+    cursor = bytes;
+    account(bytes);
+    return blocks[current].data.get();
+}
@@ -0,0 +1,72 @@
+#include "search_progress.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+// Resident set size in kB, from /proc/self/statm (0 where unavailable)
+long resident_kb() {
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    long pages_total = 0;
+    long pages_resident = 0;
+    int read = std::fscanf(statm, "%ld %ld", &pages_total, &pages_resident);
+    std::fclose(statm);
+    return read == 2 ? pages_resident * (sysconf(_SC_PAGESIZE) / 1024) : 0;
+}
+
+} // namespace
+
+ProgressSampler::ProgressSampler(const SearchProgress& p, const std::string& path, int interval)
+    : progress(p), out(nullptr), owns_out(false), interval_ms(interval > 0 ? interval : 1000), stopping(false) {
+    if (path == "-") {
+        out = stderr;
+    } else {
+        out = std::fopen(path.c_str(), "w");
+        owns_out = out != nullptr;
+    }
+    if (out) thread = std::thread(&ProgressSampler::loop, this);
+}
+
+ProgressSampler::~ProgressSampler() {
+    if (!out) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+    if (owns_out) std::fclose(out);
+}
+
+void ProgressSampler::loop() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t last_expansions = 0;
+    double last_ms = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        bool stop = wake.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return stopping; });
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        sample(elapsed, last_expansions, last_ms);
+        if (stop) return;
+    }
+}
+
+void ProgressSampler::sample(double elapsed_ms, uint64_t& last_expansions, double& last_ms) {
+    uint64_t expansions = progress.expansions_so_far();
+    double window = elapsed_ms - last_ms;
+    // The counter restarts with every search, so a drop means a new one began
+    uint64_t delta = expansions >= last_expansions ? expansions - last_expansions : expansions;
+    double rate = window > 0 ? delta / (window / 1000.0) : 0;
+    std::fprintf(out,
+                 "{\"t_ms\":%.1f,\"expanded\":%llu,\"nodes_per_sec\":%.0f,\"frontier\":%llu,\"bound\":%d,"
+                 "\"best_cost\":%d,\"rss_kb\":%ld}\n",
+                 elapsed_ms, static_cast<unsigned long long>(expansions), rate,
+                 static_cast<unsigned long long>(progress.frontier_size()), progress.current_bound(),
+                 progress.best_cost(), resident_kb());
+    std::fflush(out);
+    last_expansions = expansions;
+    last_ms = elapsed_ms;
+}
@@ -0,0 +1,39 @@
+#include "search_trace.hpp"
+#include <cstdio>
+
+SearchTrace::SearchTrace() : origin(std::chrono::steady_clock::now()) {}
+
+uint64_t SearchTrace::now_us() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void SearchTrace::span(const std::string& name, uint64_t start_us, const std::string& args) {
+    uint64_t end = now_us();
+    std::thread::id self = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(mutex);
+    int tid = 0;
+    while (tid < static_cast<int>(threads.size()) && threads[tid] != self) ++tid;
+    if (tid == static_cast<int>(threads.size())) threads.push_back(self);
+    Event e = {name, args, start_us, end - start_us, tid};
+    events.push_back(e);
+}
+
+size_t SearchTrace::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return events.size();
+}
+
+bool SearchTrace::write(const std::string& path) const {
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fprintf(out, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        std::fprintf(out, "%s{\"name\":\"%s\",\"cat\":\"search\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%d,\"args\":{%s}}",
+                     i ? ",\n" : "", e.name.c_str(), static_cast<unsigned long long>(e.start_us),
+                     static_cast<unsigned long long>(e.duration_us), e.tid, e.args.c_str());
+    }
+    std::fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    return std::fclose(out) == 0;
+}
@@ -0,0 +1,402 @@
+#include "executor.hpp"
+#include "flat_state_table.hpp"
+#include "indexed_heap.hpp"
+#include "jar_kernel.hpp"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
+// Simplified memory-bounded A* (SMA*): a tree search, with cycles checked
+// along the path, over a pool of at most `capacity` nodes. When the pool is
+// full the worst leaf (highest f, shallowest) is dropped and its parent
+// remembers its f, one value per action. Such a parent competes for
+// selection with the smallest f it forgot, and selecting it regenerates the
+// missing children with the f they had; a parent left without children
+// simply becomes a leaf again. Children inherit their parent's f (pathmax)
+// and parents back up the smallest f below them, so no selectable f
+// overestimates the cheapest solution whose path fits in the pool, and that
+// is the first goal selected: the optimal one whenever its path fits.
+//
+// A node at depth capacity - 1 has no room for children below its path, so
+// unless it is a goal it is never generated (f = infinity). With that and
+// the remembered f of every forgotten child, each selection either raises
+// an f or adds a node, and a pool too small for any solution path ends with
+// the root at infinity instead of going round in circles.
+//
+// Besides the path check, a child is skipped while another copy of its state
+// with a g and depth no larger sits in the pool: that copy, or the f its
+// parent remembers once it is dropped, already stands for every path
+// through it.
+template <class Kernel>
+class SmaStar {
+public:
+    static const int kInfinite = INT_MAX;
+
+    static const int kActionsPerJar = 4;
+
+    // Everything the search allocates once its pool holds `capacity` nodes over
+    // `jars` jars; only used to turn a byte limit into a node limit
+    static size_t pool_bytes(size_t capacity, int jars) {
+        size_t per_node = sizeof(PackedState) + 10 * sizeof(int) + sizeof(uint8_t) + 2 * 2 * sizeof(int) + sizeof(int)
+            + kActionsPerJar * jars * sizeof(int);
+        return capacity * per_node + FlatStateTable<int>::reserved_bytes(capacity);
+    }
+
+    SmaStar(const Kernel& k, MedidasBusca& s, SearchProgress& p, const StateCodec& c, SearchMemory& memory, int cap)
+        : kernel(k), stats(s), progress(p), codec(c), capacity(cap), width(kActionsPerJar * k.num_jars()), in_use(0),
+          keys(ArenaAllocator<PackedState>(&memory)), g(ArenaAllocator<int>(&memory)), f(ArenaAllocator<int>(&memory)),
+          forgotten(ArenaAllocator<int>(&memory)), remembered(ArenaAllocator<int>(&memory)),
+          parent(ArenaAllocator<int>(&memory)), action(ArenaAllocator<int>(&memory)), depth(ArenaAllocator<int>(&memory)),
+          children(ArenaAllocator<int>(&memory)), first_child(ArenaAllocator<int>(&memory)),
+          next_sibling(ArenaAllocator<int>(&memory)), prev_sibling(ArenaAllocator<int>(&memory)),
+          regenerated(ArenaAllocator<uint8_t>(&memory)), free_slots(ArenaAllocator<int>(&memory)),
+          best(BestFirst(this), &memory), worst(WorstFirst(this), &memory), index(0, &memory), expanding(-1) {
+        index.count_probes(MedidasBusca::kAtivas);
+    }
+
+    // Returns the pool slot of the goal, or -1 if no solution path fits in the pool
+    int run() {
+        typename Kernel::State current = kernel.initial_state();
+        typename Kernel::State scratch = kernel.make_state();
+        std::vector<Candidate> candidates;
+
+        int root = take(codec.encode(current.data()), -1, -1, 0, kernel.heuristic(current.data()));
+        add_leaf(root);
+        int bound = -1;
+        while (!best.empty()) {
+            int b = best.top();
+            if (key_of(b) == kInfinite) return -1;
+            codec.decode(keys[b], current.data());
+            if (children[b] == 0 && kernel.is_goal(current.data())) return b;
+            if (key_of(b) > bound) {
+                bound = key_of(b);
+                progress.set_bound(bound);
+            }
+            stats.abertos(best.size());
+            progress.expanded(best.size());
+
+            // A leaf generates all its successors, a parent the ones it forgot
+            stats.expandiu();
+            const bool again = regenerated[b] != 0;
+            if (again) stats.reabriu();
+            regenerated[b] = 1;
+            candidates.clear();
+            JarHeuristicTerms terms = kernel.heuristic_terms(current.data());
+            kernel.for_each_successor(current.data(), scratch.data(), [&](const uint16_t* child, int cost, int jar, int type) {
+                stats.gerou();
+                int a = jar * kActionsPerJar + type;
+                int& memo = remembered[static_cast<size_t>(b) * width + a];
+                // In the pool, or nothing left to find below it
+                if (again && memo == kInfinite) return;
+                int known_f = again ? memo : 0;
+                memo = kInfinite;
+                PackedState key = codec.encode(child);
+                if (on_path(b, key)) {
+                    stats.duplicado();
+                    return;
+                }
+                int child_g = g[b] + cost;
+                const int* copy = index.find(key);
+                if (copy && g[*copy] <= child_g && depth[*copy] <= depth[b] + 1) {
+                    stats.duplicado();
+                    return;
+                }
+                if (depth[b] + 1 >= capacity - 1 && !kernel.is_goal(child)) return; // f = infinity
+                Candidate c = {key, a, child_g, std::max(std::max(f[b], known_f), child_g + kernel.child_heuristic(terms, current.data(), child, jar, type))};
+                candidates.push_back(c);
+            });
+            std::stable_sort(candidates.begin(), candidates.end());
+
+            best.erase(b);
+            if (worst.contains(b)) worst.erase(b);
+            expanding = b;
+            forgotten[b] = kInfinite; // every missing successor is a candidate now
+            size_t fit = 0;
+            for (; fit < candidates.size(); ++fit) {
+                // A full pool trades its worst leaf for a better child; the
+                // first child always gets in so that every selection progresses
+                if (full()) {
+                    if (worst.empty() || (fit > 0 && f[worst.top()] <= candidates[fit].f)) break;
+                    drop(worst.top());
+                }
+                add_leaf(take(candidates[fit].key, b, candidates[fit].action, candidates[fit].g, candidates[fit].f));
+            }
+            for (size_t i = fit; i < candidates.size(); ++i) forget(b, candidates[i].action, candidates[i].f);
+            expanding = -1;
+
+            if (children[b] == 0) {
+                // Dead end, or no room for even one child below this path
+                f[b] = kInfinite;
+                add_leaf(b);
+                back_up(parent[b]);
+            } else {
+                if (forgotten[b] != kInfinite) best.push(b);
+                back_up(b);
+            }
+            stats.fechados(in_use);
+        }
+        return -1;
+    }
+
+    void report_probes() const { stats.sondagens(index.probe_lookups(), index.probe_steps()); }
+
+    // Appends the path root .. slot to the arena
+    void store_path(NodeArena& nodes, int slot) const {
+        std::vector<int> path;
+        for (int s = slot; s != -1; s = parent[s]) path.push_back(s);
+        typename Kernel::State values = kernel.make_state();
+        int first = nodes.size();
+        for (size_t d = path.size(); d-- > 0;) {
+            int s = path[d];
+            codec.decode(keys[s], values.data());
+            int idx = nodes.add(values.data(), nodes.size() == first ? -1 : nodes.size() - 1, g[s], f[s]);
+            nodes.set_visited(idx);
+            if (d > 0) nodes.set_closed(idx);
+        }
+    }
+
+private:
+    struct Candidate {
+        PackedState key;
+        int action;
+        int g;
+        int f;
+        bool operator<(const Candidate& o) const { return f < o.f; }
+    };
+    // Lowest key first, deepest on ties
+    struct BestFirst {
+        const SmaStar* s;
+        explicit BestFirst(const SmaStar* self) : s(self) {}
+        bool operator()(int a, int b) const {
+            int fa = s->key_of(a);
+            int fb = s->key_of(b);
+            if (fa != fb) return fa < fb;
+            if (s->depth[a] != s->depth[b]) return s->depth[a] > s->depth[b];
+            return a < b;
+        }
+    };
+    // Highest f first, shallowest on ties
+    struct WorstFirst {
+        const SmaStar* s;
+        explicit WorstFirst(const SmaStar* self) : s(self) {}
+        bool operator()(int a, int b) const {
+            if (s->f[a] != s->f[b]) return s->f[a] > s->f[b];
+            if (s->depth[a] != s->depth[b]) return s->depth[a] < s->depth[b];
+            return a > b;
+        }
+    };
+
+    const Kernel& kernel;
+    MedidasBusca& stats;
+    SearchProgress& progress;
+    const StateCodec& codec;
+    int capacity;
+    int width; // remembered f values per node, one per action
+    size_t in_use;
+    // Pool, one entry per slot; the children of a node form a doubly linked list
+    ArenaVector<PackedState> keys;
+    ArenaVector<int> g;
+    ArenaVector<int> f;         // backed-up f
+    ArenaVector<int> forgotten;  // smallest f among dropped children
+    ArenaVector<int> remembered; // per action: f of the dropped child, infinite when there is nothing to regenerate
+    ArenaVector<int> parent;
+    ArenaVector<int> action; // that generated the node from its parent
+    ArenaVector<int> depth;
+    ArenaVector<int> children;
+    ArenaVector<int> first_child;
+    ArenaVector<int> next_sibling;
+    ArenaVector<int> prev_sibling;
+    ArenaVector<uint8_t> regenerated; // expanded before, its subtree was dropped since
+    ArenaVector<int> free_slots;
+    IndexedHeap<BestFirst> best;   // leaves, and parents with forgotten children
+    IndexedHeap<WorstFirst> worst; // leaves
+    FlatStateTable<int> index;     // state -> its cheapest copy in the pool
+    int expanding;                 // node whose children are being added
+
+    // Selection key: a leaf's f, or the smallest f a parent forgot
+    int key_of(int s) const { return children[s] == 0 ? f[s] : forgotten[s]; }
+
+    // Slots are added as the pool grows, up to `capacity`; dropped ones are reused
+    bool full() const { return free_slots.empty() && keys.size() == static_cast<size_t>(capacity); }
+
+    int new_slot() {
+        if (!free_slots.empty()) {
+            int s = free_slots.back();
+            free_slots.pop_back();
+            return s;
+        }
+        size_t n = keys.size();
+        if (n == keys.capacity()) reserve(std::min(std::max<size_t>(2 * n, 64), static_cast<size_t>(capacity)));
+        keys.resize(n + 1);
+        g.resize(n + 1);
+        f.resize(n + 1);
+        forgotten.resize(n + 1);
+        remembered.resize((n + 1) * width, static_cast<int>(kInfinite));
+        parent.resize(n + 1);
+        action.resize(n + 1);
+        depth.resize(n + 1);
+        children.resize(n + 1);
+        first_child.resize(n + 1);
+        next_sibling.resize(n + 1);
+        prev_sibling.resize(n + 1);
+        regenerated.resize(n + 1);
+        return static_cast<int>(n);
+    }
+
+    // Grows every slot array to `slots` at once, never past the capacity
+    void reserve(size_t slots) {
+        keys.reserve(slots);
+        g.reserve(slots);
+        f.reserve(slots);
+        forgotten.reserve(slots);
+        remembered.reserve(slots * width);
+        parent.reserve(slots);
+        action.reserve(slots);
+        depth.reserve(slots);
+        children.reserve(slots);
+        first_child.reserve(slots);
+        next_sibling.reserve(slots);
+        prev_sibling.reserve(slots);
+        regenerated.reserve(slots);
+        best.reserve(slots);
+        worst.reserve(slots);
+    }
+
+    int take(const PackedState& key, int p, int a, int cost, int f_value) {
+        int s = new_slot();
+        ++in_use;
+        keys[s] = key;
+        g[s] = cost;
+        f[s] = f_value;
+        forgotten[s] = kInfinite;
+        parent[s] = p;
+        action[s] = a;
+        depth[s] = p == -1 ? 0 : depth[p] + 1;
+        children[s] = 0;
+        first_child[s] = -1;
+        prev_sibling[s] = -1;
+        next_sibling[s] = -1;
+        regenerated[s] = 0;
+        int* copy = index.find(key);
+        if (!copy) index.insert(key, s);
+        else if (g[*copy] > cost) *copy = s;
+        if (p != -1) {
+            next_sibling[s] = first_child[p];
+            if (first_child[p] != -1) prev_sibling[first_child[p]] = s;
+            first_child[p] = s;
+            ++children[p];
+        }
+        stats.guardou();
+        return s;
+    }
+
+    void add_leaf(int s) {
+        best.push(s);
+        worst.push(s);
+    }
+
+    void remove_leaf(int s) {
+        best.erase(s);
+        worst.erase(s);
+    }
+
+    // Removes leaf s from the tree. Its parent remembers f(s) and becomes
+    // selectable with it, as a leaf if s was its last child.
+    void drop(int s) {
+        remove_leaf(s);
+        int p = parent[s];
+        if (p != -1) {
+            if (prev_sibling[s] != -1) next_sibling[prev_sibling[s]] = next_sibling[s];
+            else first_child[p] = next_sibling[s];
+            if (next_sibling[s] != -1) prev_sibling[next_sibling[s]] = prev_sibling[s];
+            --children[p];
+            forget(p, action[s], f[s]);
+            // The node being expanded is still collecting its forgotten f
+            if (p != expanding) {
+                if (children[p] == 0) f[p] = std::max(f[p], forgotten[p]);
+                if (best.contains(p)) best.update(p);
+                else best.push(p);
+                if (children[p] == 0) worst.push(p);
+            }
+        }
+        const int* copy = index.find(keys[s]);
+        if (copy && *copy == s) index.erase(keys[s]);
+        free_slots.push_back(s);
+        --in_use;
+    }
+
+    void forget(int p, int a, int f_value) {
+        remembered[static_cast<size_t>(p) * width + a] = f_value;
+        forgotten[p] = std::min(forgotten[p], f_value);
+    }
+
+    // f(n) = smallest f among its children and forgotten children, up the tree
+    // while it changes
+    void back_up(int n) {
+        while (n != -1) {
+            int m = forgotten[n];
+            for (int c = first_child[n]; c != -1; c = next_sibling[c]) m = std::min(m, f[c]);
+            m = std::max(m, f[n]);
+            if (m == f[n]) return;
+            f[n] = m;
+            n = parent[n];
+        }
+    }
+
+    bool on_path(int s, const PackedState& key) const {
+        for (; s != -1; s = parent[s]) {
+            if (keys[s] == key) return true;
+        }
+        return false;
+    }
+};
+
+struct SmaStarRunner {
+    NodeArena& nodes;
+    MedidasBusca& stats;
+    SearchProgress& progress;
+    const StateCodec& codec;
+    SearchMemory& memory;
+    uint64_t node_limit;
+    uint64_t byte_limit;
+    bool found;
+
+    template <class Kernel>
+    void operator()(const Kernel& kernel) {
+        uint64_t capacity = std::min<uint64_t>(node_limit, INT_MAX);
+        const int jars = kernel.num_jars();
+        while (byte_limit && capacity > 0 && SmaStar<Kernel>::pool_bytes(capacity, jars) > byte_limit) {
+            capacity = std::min(capacity - 1, capacity * byte_limit / SmaStar<Kernel>::pool_bytes(capacity, jars));
+        }
+        if (capacity == 0) return;
+        SmaStar<Kernel> search(kernel, stats, progress, codec, memory, static_cast<int>(capacity));
+        int goal = search.run();
+        search.report_probes();
+        found = goal != -1;
+        if (found) search.store_path(nodes, goal);
+    }
+};
+
+// The pool grows with the search up to sma_node_limit / sma_byte_limit, so
+// memory use is bounded by them however large the state space is, and a
+// small instance only pays for the nodes it holds. The arena ends up
+// holding just the solution path.
+void SearchAlgorithms::solve_with_sma_star(const std::vector<Jar>& initial_jars) {
+    begin_search();
+    if (initial_jars.empty()) return;
+
+    StateCodec codec(initial_jars);
+    if (!codec.valid() || !kernel_supports(initial_jars)) {
+        if (verbose) std::cout << "Instance not supported by the search kernels.\n";
+        return;
+    }
+
+    nodes.reset(initial_jars);
+    SmaStarRunner runner = {nodes, medidas, progress, codec, memory, sma_node_limit, sma_byte_limit, false};
+    with_jar_kernel(initial_jars, search_heuristic(initial_jars), runner);
+    record_goal(runner.found ? nodes.size() - 1 : -1);
+
+    if (!runner.found) {
+        if (verbose) std::cout << "No solution within the memory limit.\n";
+    }
+}
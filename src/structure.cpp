@@ -42,10 +42,10 @@ int Jar::transfer(int amount) {
 }
 
 GameState::GameState()
-    : parent(-1), closed(false), g_cost(0), f_cost(0), index(-1), target_Q(0), max_cap(0), num_jars(0) {}
+    : parent(-1), visited(false), closed(false), g_cost(0), f_cost(0), index(-1), target_Q(0), max_cap(0), num_jars(0) {}
 
 GameState::GameState(const vector<Jar>& j, int p)
-    : jars(j), parent(p), closed(false), g_cost(0), f_cost(0), num_jars(j.size()) {
+    : jars(j), parent(p), visited(false), closed(false), g_cost(0), f_cost(0), num_jars(j.size()) {
     values.reserve(num_jars);
     max_cap = 0;
     target_Q = (num_jars > 0) ? INT_MAX : 0;
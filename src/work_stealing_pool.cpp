@@ -0,0 +1,79 @@
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int threads) : queued(0), pending(0), next_queue(0), stopping(false) {
+    int n = std::max(1, threads);
+    for (int w = 0; w < n; ++w) queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    for (int w = 0; w < n; ++w) this->threads.push_back(std::thread(&WorkStealingPool::worker_loop, this, w));
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+}
+
+void WorkStealingPool::submit(const Task& task) {
+    pending.fetch_add(1);
+    Queue& q = *queues[next_queue.fetch_add(1) % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(task);
+    }
+    {
+        // Counted under the pool mutex so a worker about to sleep cannot miss it
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.fetch_add(1);
+    }
+    wake.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return pending.load() == 0; });
+}
+
+bool WorkStealingPool::pop_local(int w, Task& task) {
+    Queue& q = *queues[w];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) return false;
+    task.swap(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int w, Task& task) {
+    int n = size();
+    for (int k = 1; k < n; ++k) {
+        Queue& q = *queues[(w + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        task.swap(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::worker_loop(int w) {
+    Task task;
+    while (true) {
+        if (pop_local(w, task) || steal(w, task)) {
+            queued.fetch_sub(1);
+            task(w);
+            task = Task();
+            if (pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0) return;
+    }
+}